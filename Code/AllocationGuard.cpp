@@ -0,0 +1,46 @@
+#include "AllocationGuard.hpp"
+
+#if GREG_ENABLE_ALLOCATION_GUARD
+
+    #include <utility>
+
+namespace {
+    // Plain ints, so reading them from inside malloc never needs to allocate
+    thread_local int gGuardDepth    = 0;
+    thread_local int gCountingDepth = 0;
+    thread_local int gNumCounted    = 0;
+}  // namespace
+
+ScopedAllocationGuard::ScopedAllocationGuard(Mode mode) : mMode(mode) {
+    ++gGuardDepth;
+    if (mMode == Mode::counting) ++gCountingDepth;
+}
+
+ScopedAllocationGuard::~ScopedAllocationGuard() {
+    --gGuardDepth;
+    if (mMode == Mode::counting) --gCountingDepth;
+}
+
+bool ScopedAllocationGuard::isActive() {
+    return gGuardDepth > 0;
+}
+
+int ScopedAllocationGuard::getNumCountedCalls() {
+    return gNumCounted;
+}
+
+void ScopedAllocationGuard::checkAllocation() {
+    if (gGuardDepth == 0) return;
+
+    if (gCountingDepth > 0) {
+        ++gNumCounted;
+        return;
+    }
+
+    // Drop the guard while asserting, the assertion logger is allowed to allocate
+    const auto depth = std::exchange(gGuardDepth, 0);
+    jassertfalse;  // Something allocated on a thread that promised not to (e.g. the audio thread)
+    gGuardDepth = depth;
+}
+
+#endif
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#ifndef GREG_ENABLE_ALLOCATION_GUARD
+    #define GREG_ENABLE_ALLOCATION_GUARD JUCE_DEBUG
+#endif
+
+/**
+ * Asserts if the current thread calls the C heap (malloc, calloc, realloc, free and their aligned variants) while an
+ * instance is in scope. Everything that allocates through them is covered with them: operator new/delete,
+ * juce::HeapBlock and so AudioBuffer::setSize()/makeCopyOf().
+ *
+ * The checks are hooks below the C library's allocator, in AllocationHooks.cpp, for glibc, the macOS default malloc
+ * zone and the Windows debug CRT. Only debug builds of GregBench and the standalone app compile them: a plugin
+ * bundle must leave its host's allocator alone, so in the VST3 and LV2 bundles a guard only sets isActive(). With
+ * GREG_ENABLE_ALLOCATION_GUARD off (the release default) this compiles to nothing.
+ */
+class ScopedAllocationGuard {
+public:
+    /** What a heap call under the guard does. Counting is for tests that provoke one on purpose. */
+    enum class Mode { asserting, counting };
+
+#if GREG_ENABLE_ALLOCATION_GUARD
+    explicit ScopedAllocationGuard(Mode mode = Mode::asserting);
+    ~ScopedAllocationGuard();
+
+    static bool isActive();
+
+    /** Heap calls made on this thread under a counting guard so far. */
+    static int getNumCountedCalls();
+
+    /** Asserts or counts if a guard is in scope on the calling thread. Called by every hooked heap function. */
+    static void checkAllocation();
+
+private:
+    Mode mMode;
+#else
+    explicit ScopedAllocationGuard(Mode = Mode::asserting) {}
+
+    static bool isActive() {
+        return false;
+    }
+
+    static int getNumCountedCalls() {
+        return 0;
+    }
+#endif
+
+private:
+    JUCE_DECLARE_NON_COPYABLE(ScopedAllocationGuard)
+};
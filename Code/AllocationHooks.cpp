@@ -0,0 +1,146 @@
+#include "AllocationGuard.hpp"
+
+// Hooks below the C library's allocator that call ScopedAllocationGuard::checkAllocation(), only compiled into debug
+// builds of the executables. A plugin bundle must not replace the allocator of the host it is loaded into, so
+// CMakeLists.txt leaves this file out of the plugin formats. operator new/delete and juce::HeapBlock end up in these
+// functions on every platform, so they need no hooks of their own.
+
+#if GREG_ENABLE_ALLOCATION_GUARD
+
+    #if defined(__GLIBC__)
+        #include <cerrno>
+        #include <cstdlib>
+
+// glibc supports replacing malloc in the executable, its own implementation stays reachable under these names
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* ptr, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(std::size_t size) noexcept {
+    ScopedAllocationGuard::checkAllocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept {
+    ScopedAllocationGuard::checkAllocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, std::size_t size) noexcept {
+    ScopedAllocationGuard::checkAllocation();
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) noexcept {
+    ScopedAllocationGuard::checkAllocation();
+    __libc_free(ptr);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept {
+    ScopedAllocationGuard::checkAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+void* memalign(std::size_t alignment, std::size_t size) noexcept {
+    ScopedAllocationGuard::checkAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** result, std::size_t alignment, std::size_t size) noexcept {
+    ScopedAllocationGuard::checkAllocation();
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) return EINVAL;
+
+    auto* ptr = __libc_memalign(alignment, size);
+    if (ptr == nullptr) return ENOMEM;
+
+    *result = ptr;
+    return 0;
+}
+}
+
+    #elif JUCE_MAC
+        #include <mach/mach.h>
+        #include <malloc/malloc.h>
+
+namespace {
+    // The default zone's functions from before the hooks went in
+    malloc_zone_t gOriginalZone;
+
+    void* zoneMalloc(malloc_zone_t* zone, std::size_t size) {
+        ScopedAllocationGuard::checkAllocation();
+        return gOriginalZone.malloc(zone, size);
+    }
+
+    void* zoneCalloc(malloc_zone_t* zone, std::size_t count, std::size_t size) {
+        ScopedAllocationGuard::checkAllocation();
+        return gOriginalZone.calloc(zone, count, size);
+    }
+
+    void* zoneValloc(malloc_zone_t* zone, std::size_t size) {
+        ScopedAllocationGuard::checkAllocation();
+        return gOriginalZone.valloc(zone, size);
+    }
+
+    void* zoneRealloc(malloc_zone_t* zone, void* ptr, std::size_t size) {
+        ScopedAllocationGuard::checkAllocation();
+        return gOriginalZone.realloc(zone, ptr, size);
+    }
+
+    void* zoneMemalign(malloc_zone_t* zone, std::size_t alignment, std::size_t size) {
+        ScopedAllocationGuard::checkAllocation();
+        return gOriginalZone.memalign(zone, alignment, size);
+    }
+
+    void zoneFree(malloc_zone_t* zone, void* ptr) {
+        ScopedAllocationGuard::checkAllocation();
+        gOriginalZone.free(zone, ptr);
+    }
+
+    void zoneFreeDefiniteSize(malloc_zone_t* zone, void* ptr, std::size_t size) {
+        ScopedAllocationGuard::checkAllocation();
+        gOriginalZone.free_definite_size(zone, ptr, size);
+    }
+
+    // malloc() and friends go through the default zone's function table, which is read-only once set up
+    bool installZoneHooks() {
+        auto* zone    = malloc_default_zone();
+        gOriginalZone = *zone;
+
+        const auto address = reinterpret_cast<vm_address_t>(zone);
+        vm_protect(mach_task_self(), address, sizeof(malloc_zone_t), false, VM_PROT_READ | VM_PROT_WRITE);
+
+        zone->malloc  = zoneMalloc;
+        zone->calloc  = zoneCalloc;
+        zone->valloc  = zoneValloc;
+        zone->realloc = zoneRealloc;
+        zone->free    = zoneFree;
+        if (zone->version >= 5) zone->memalign = zoneMemalign;
+        if (zone->version >= 6) zone->free_definite_size = zoneFreeDefiniteSize;
+
+        vm_protect(mach_task_self(), address, sizeof(malloc_zone_t), false, VM_PROT_READ);
+        return true;
+    }
+
+    const bool gZoneHooksInstalled = installZoneHooks();
+}  // namespace
+
+    #elif JUCE_WINDOWS && defined(_DEBUG)
+        #include <crtdbg.h>
+
+namespace {
+    int allocationHook(int, void*, std::size_t, int blockType, long, const unsigned char*, int) {
+        // The CRT's own bookkeeping isn't the program's doing
+        if (blockType != _CRT_BLOCK) ScopedAllocationGuard::checkAllocation();
+        return TRUE;
+    }
+
+    // The debug CRT routes malloc, _aligned_malloc, free and operator new/delete through this hook
+    const auto gPreviousHook = _CrtSetAllocHook(allocationHook);
+}  // namespace
+
+    #endif
+
+#endif
@@ -0,0 +1,395 @@
+#include "AntiderivativeShaper.hpp"
+#include "SaturationKernel.hpp"
+#include "TableBuilder.hpp"
+
+namespace {
+    constexpr double kDriveStepDb     = 0.1;
+    constexpr int kNumSlices          = 301;  // 0 to 30 dB
+    constexpr int kIntervalsPerSlice  = 1024;
+    constexpr double kSnapToSliceDb   = 1.0e-4;  // Settled drives are multiples of 0.1 dB up to float rounding
+    constexpr double kGaussNodeOffset = 0.77459666924148337704;  // sqrt(3/5), 3 point Gauss-Legendre
+
+    double analyticCurve(double input, double drive) {
+        return SaturationKernel::saturate(input, drive);
+    }
+
+    double sliceDrive(int index) {
+        return std::pow(10.0, index * kDriveStepDb / 20.0);
+    }
+
+    struct Node {
+        double f  = 0.0;
+        double f1 = 0.0;
+        double f2 = 0.0;
+    };
+
+    struct Slice {
+        double drive       = 0.0;  // Linear gain
+        double step        = 0.0;
+        double inverseStep = 0.0;
+        double range       = 0.0;  // Past this the curve is +-1
+        const Node* nodes  = nullptr;
+    };
+
+    // f, F1 and F2 at one input
+    struct Values {
+        double f  = 0.0;
+        double f1 = 0.0;
+        double f2 = 0.0;
+    };
+
+    class Table {
+    public:
+        Table()
+            : mNodes(static_cast<size_t>(kNumSlices * (kIntervalsPerSlice + 1))),
+              mSlices(static_cast<size_t>(kNumSlices)) {
+            for (int index = 0; index < kNumSlices; ++index) {
+                const double drive = sliceDrive(index);
+
+                auto& slice       = mSlices[static_cast<size_t>(index)];
+                slice.drive       = drive;
+                slice.range       = 9.0 / drive + 0.3;
+                slice.step        = slice.range / kIntervalsPerSlice;
+                slice.inverseStep = 1.0 / slice.step;
+                slice.nodes       = mNodes.data() + index * (kIntervalsPerSlice + 1);
+
+                auto* nodes = mNodes.data() + index * (kIntervalsPerSlice + 1);
+                nodes[0].f  = analyticCurve(0.0, drive);
+
+                for (int i = 0; i < kIntervalsPerSlice; ++i) {
+                    const double start  = i * slice.step;
+                    const double middle = start + 0.5 * slice.step;
+                    const double offset = 0.5 * slice.step * kGaussNodeOffset;
+
+                    // F1 integrates the exact curve (Gauss-Legendre is exact to degree 5), F2 integrates the cubic
+                    // Hermite interpolant of F1 exactly, so it is consistent with how F1 is read back
+                    const double area = 0.5 * slice.step
+                                      * (5.0 / 9.0 * analyticCurve(middle - offset, drive)
+                                         + 8.0 / 9.0 * analyticCurve(middle, drive)
+                                         + 5.0 / 9.0 * analyticCurve(middle + offset, drive));
+
+                    auto& current = nodes[i];
+                    auto& next    = nodes[i + 1];
+                    next.f        = analyticCurve(start + slice.step, drive);
+                    next.f1       = current.f1 + area;
+                    next.f2       = current.f2 + 0.5 * slice.step * (current.f1 + next.f1)
+                              + slice.step * slice.step / 12.0 * (current.f - next.f);
+                }
+            }
+        }
+
+        const Slice& getSlice(int index) const {
+            return mSlices[static_cast<size_t>(index)];
+        }
+
+    private:
+        std::vector<Node> mNodes;
+        std::vector<Slice> mSlices;
+    };
+
+    std::atomic<const Table*> gTable {nullptr};
+
+    Values evaluate(const Slice& slice, double input) {
+        const double magnitude = std::abs(input);
+        const double sign      = input < 0.0 ? -1.0 : 1.0;
+        const double position  = magnitude * slice.inverseStep;
+
+        // F1 is even and F2 odd, past the range they continue the +-1 asymptote analytically
+        if (position >= kIntervalsPerSlice) {
+            const auto& last    = slice.nodes[kIntervalsPerSlice];
+            const double beyond = magnitude - slice.range;
+            return {sign, last.f1 + beyond, sign * (last.f2 + last.f1 * beyond + 0.5 * beyond * beyond)};
+        }
+
+        const int index = static_cast<int>(position);
+        const double t  = position - index;
+        const double t2 = t * t;
+        const double t3 = t2 * t;
+        const auto& a   = slice.nodes[index];
+        const auto& b   = slice.nodes[index + 1];
+        const double h  = slice.step;
+
+        // Cubic Hermite basis and its derivative
+        const double h00 = 2.0 * t3 - 3.0 * t2 + 1.0;
+        const double h10 = t3 - 2.0 * t2 + t;
+        const double h01 = 3.0 * t2 - 2.0 * t3;
+        const double h11 = t3 - t2;
+
+        const double d00 = 6.0 * (t2 - t);
+        const double d10 = 3.0 * t2 - 4.0 * t + 1.0;
+        const double d11 = 3.0 * t2 - 2.0 * t;
+
+        Values values;
+        values.f1 = h00 * a.f1 + h01 * b.f1 + h * (h10 * a.f + h11 * b.f);
+        values.f2 = sign * (h00 * a.f2 + h01 * b.f2 + h * (h10 * a.f1 + h11 * b.f1));
+
+        // The curve is read as the slope of the F1 interpolant, so the fallbacks agree with the divided differences
+        values.f = sign * (d00 * (a.f1 - b.f1) * slice.inverseStep + d10 * a.f + d11 * b.f);
+        return values;
+    }
+
+    // A drive between slices is read from the four around it, all at the same driven input u = d * x. At a fixed x
+    // the curve swings by up to 0.09 from one slice to the next at high drive, in u it is tanh(u + 0.3 d sin(2u)),
+    // which is smooth in d. Cubic Lagrange weights over the slices' dB positions, with F1 and F2 rescaled from each
+    // slice's x to this drive's, keep the three values the exact antiderivatives of one blended curve.
+    struct DrivePosition {
+        std::array<const Slice*, 4> slices {};
+        std::array<double, 4> weights {};
+        std::array<double, 4> inputScales {};  // d / d_slice
+        int numSlices = 1;                     // Just the first on a slice
+    };
+
+    DrivePosition locate(const Table& table, double driveDb) {
+        auto position        = juce::jlimit(0.0, static_cast<double>(kNumSlices - 1), driveDb / kDriveStepDb);
+        const double nearest = std::round(position);
+        if (std::abs(position - nearest) < kSnapToSliceDb / kDriveStepDb) position = nearest;
+
+        DrivePosition drive;
+        if (position == nearest) {
+            drive.slices[0]      = &table.getSlice(static_cast<int>(nearest));
+            drive.weights[0]     = 1.0;
+            drive.inputScales[0] = 1.0;
+            return drive;
+        }
+
+        const int first     = juce::jlimit(0, kNumSlices - 4, static_cast<int>(position) - 1);
+        const double gain   = std::pow(10.0, position * kDriveStepDb / 20.0);
+        const double offset = position - first;
+        drive.numSlices     = 4;
+
+        for (int i = 0; i < 4; ++i) {
+            double weight = 1.0;
+            for (int other = 0; other < 4; ++other) {
+                if (other != i) weight *= (offset - other) / (i - other);
+            }
+
+            const auto& slice        = table.getSlice(first + i);
+            const auto index         = static_cast<size_t>(i);
+            drive.slices[index]      = &slice;
+            drive.weights[index]     = weight;
+            drive.inputScales[index] = gain / slice.drive;
+        }
+        return drive;
+    }
+
+    Values evaluate(const DrivePosition& drive, double input) {
+        if (drive.numSlices == 1) return evaluate(*drive.slices[0], input);
+
+        Values blended;
+        for (size_t i = 0; i < 4; ++i) {
+            const double scale = drive.inputScales[i];
+            const double w     = drive.weights[i];
+            const auto values  = evaluate(*drive.slices[i], input * scale);
+
+            blended.f  += w * values.f;
+            blended.f1 += w * values.f1 / scale;
+            blended.f2 += w * values.f2 / (scale * scale);
+        }
+        return blended;
+    }
+
+    // Drive either comes as one value per sample or as a single settled value for the whole span
+    template<typename SampleType>
+    double driveAt(const SampleType* driveDb, int index) {
+        return static_cast<double>(driveDb[index]);
+    }
+
+    double driveAt(float driveDb, int) {
+        return static_cast<double>(driveDb);
+    }
+
+    // (F(a) - F(b)) / (a - b), or the lower antiderivative at the midpoint where that is ill-conditioned
+    double dividedDifference(const DrivePosition& drive, double a, double b, double f2a, double f2b) {
+        if (std::abs(a - b) < AntiderivativeShaper::kTolerance) return evaluate(drive, 0.5 * (a + b)).f1;
+        return (f2a - f2b) / (a - b);
+    }
+
+    // A ramping drive changes the antiderivatives from one sample to the next. The history is re-evaluated with
+    // the current drive every sample, mixing two drives in one divided difference would not cancel.
+    template<typename SampleType, typename DriveSource>
+    void processFirstOrder(const Table& table, double& x1, SampleType* data, DriveSource driveDb, int numSamples) {
+        constexpr bool isSettled = std::is_same_v<DriveSource, float>;
+
+        auto drive      = locate(table, driveAt(driveDb, 0));
+        double previous = evaluate(drive, x1).f1;
+
+        for (int i = 0; i < numSamples; ++i) {
+            if constexpr (!isSettled) {
+                drive    = locate(table, driveAt(driveDb, i));
+                previous = evaluate(drive, x1).f1;
+            }
+
+            const double x          = static_cast<double>(data[i]);
+            const double current    = evaluate(drive, x).f1;
+            const double difference = x - x1;
+
+            const double y = std::abs(difference) < AntiderivativeShaper::kTolerance
+                               ? evaluate(drive, 0.5 * (x + x1)).f
+                               : (current - previous) / difference;
+
+            data[i]  = static_cast<SampleType>(y);
+            x1       = x;
+            previous = current;
+        }
+    }
+
+    template<typename SampleType, typename DriveSource>
+    void processSecondOrder(const Table& table,
+                            double& x1,
+                            double& x2,
+                            double& d1,
+                            SampleType* data,
+                            DriveSource driveDb,
+                            int numSamples) {
+        constexpr bool isSettled = std::is_same_v<DriveSource, float>;
+
+        auto drive        = locate(table, driveAt(driveDb, 0));
+        double previousF2 = evaluate(drive, x1).f2;
+
+        for (int i = 0; i < numSamples; ++i) {
+            if constexpr (!isSettled) {
+                drive      = locate(table, driveAt(driveDb, i));
+                previousF2 = evaluate(drive, x1).f2;
+                d1         = dividedDifference(drive, x1, x2, previousF2, evaluate(drive, x2).f2);
+            }
+
+            const double x         = static_cast<double>(data[i]);
+            const double currentF2 = evaluate(drive, x).f2;
+            const double currentD1 = dividedDifference(drive, x, x1, currentF2, previousF2);
+
+            double y;
+            if (std::abs(x - x2) < AntiderivativeShaper::kTolerance) {
+                // x[n] and x[n-2] coincide, average around their midpoint instead
+                const double middle = 0.5 * (x + x2);
+                const double delta  = middle - x1;
+
+                if (std::abs(delta) < AntiderivativeShaper::kTolerance) {
+                    y = evaluate(drive, 0.5 * (middle + x1)).f;
+                } else {
+                    const auto atMiddle = evaluate(drive, middle);
+                    y                   = 2.0 / delta * (atMiddle.f1 + (previousF2 - atMiddle.f2) / delta);
+                }
+            } else {
+                y = 2.0 * (currentD1 - d1) / (x - x2);
+            }
+
+            data[i]    = static_cast<SampleType>(y);
+            x2         = x1;
+            x1         = x;
+            d1         = currentD1;
+            previousF2 = currentF2;
+        }
+    }
+}  // namespace
+
+void AntiderivativeShaper::buildTable() {
+    static const Table table;
+    gTable.store(&table, std::memory_order_release);
+}
+
+void AntiderivativeShaper::buildTableAsync() {
+    static TableBuilder builder("Greg ADAA table", buildTable, isTableReady);
+    builder.start();
+}
+
+bool AntiderivativeShaper::isTableReady() {
+    return gTable.load(std::memory_order_acquire) != nullptr;
+}
+
+void AntiderivativeShaper::prepare(int numChannels) {
+    mHistory.assign(static_cast<size_t>(numChannels), {});
+}
+
+void AntiderivativeShaper::reset() {
+    std::fill(mHistory.begin(), mHistory.end(), History {});
+}
+
+template<typename SampleType>
+void AntiderivativeShaper::process(int channel,
+                                   SampleType* data,
+                                   const SampleType* driveDb,
+                                   int numSamples,
+                                   int order) {
+    const auto* table = gTable.load(std::memory_order_acquire);
+    jassert(table != nullptr && channel < static_cast<int>(mHistory.size()));
+    if (numSamples <= 0) return;
+
+    auto& history = mHistory[static_cast<size_t>(channel)];
+    if (order >= 2) processSecondOrder(*table, history.x1, history.x2, history.d1, data, driveDb, numSamples);
+    else processFirstOrder(*table, history.x1, data, driveDb, numSamples);
+}
+
+template<typename SampleType>
+void AntiderivativeShaper::process(int channel, SampleType* data, float driveDb, int numSamples, int order) {
+    const auto* table = gTable.load(std::memory_order_acquire);
+    jassert(table != nullptr && channel < static_cast<int>(mHistory.size()));
+    if (numSamples <= 0) return;
+
+    auto& history = mHistory[static_cast<size_t>(channel)];
+    if (order >= 2) processSecondOrder(*table, history.x1, history.x2, history.d1, data, driveDb, numSamples);
+    else processFirstOrder(*table, history.x1, data, driveDb, numSamples);
+}
+
+template void AntiderivativeShaper::process(int, float*, const float*, int, int);
+template void AntiderivativeShaper::process(int, double*, const double*, int, int);
+template void AntiderivativeShaper::process(int, float*, float, int, int);
+template void AntiderivativeShaper::process(int, double*, float, int, int);
+
+AntiderivativeShaper::Accuracy AntiderivativeShaper::measureAccuracy() {
+    buildTable();
+    const auto& table = *gTable.load();
+
+    constexpr double inputRange = 12.0;
+    constexpr int numInputs     = 10001;
+    constexpr int numSubSteps   = 16;
+
+    Accuracy accuracy;
+
+    for (int index = 0; index < kNumSlices; ++index) {
+        const double drive = sliceDrive(index);
+        const auto& slice  = table.getSlice(index);
+        const double step  = inputRange / (numInputs - 1);
+
+        // Integrate the analytic curve alongside, much finer than the table's own steps
+        double reference = 0.0;
+
+        for (int i = 0; i < numInputs; ++i) {
+            const double input = i * step;
+
+            if (i > 0) {
+                const double subStep = step / numSubSteps;
+                for (int sub = 0; sub < numSubSteps; ++sub) {
+                    const double middle = input - step + (sub + 0.5) * subStep;
+                    const double offset = 0.5 * subStep * kGaussNodeOffset;
+                    reference += 0.5 * subStep
+                               * (5.0 / 9.0 * analyticCurve(middle - offset, drive)
+                                  + 8.0 / 9.0 * analyticCurve(middle, drive)
+                                  + 5.0 / 9.0 * analyticCurve(middle + offset, drive));
+                }
+            }
+
+            for (const double signedInput : {input, -input}) {
+                const auto values = evaluate(slice, signedInput);
+                const auto curve  = std::abs(values.f - analyticCurve(signedInput, drive));
+
+                accuracy.maxCurveError = juce::jmax(accuracy.maxCurveError, curve);
+                accuracy.maxFirstError = juce::jmax(accuracy.maxFirstError, std::abs(values.f1 - reference));
+            }
+        }
+
+        if (index + 1 == kNumSlices) continue;
+
+        const double middleDb = (index + 0.5) * kDriveStepDb;
+        const auto middle     = locate(table, middleDb);
+        const double gain     = std::pow(10.0, middleDb / 20.0);
+
+        for (int i = 0; i < numInputs; ++i) {
+            for (const double input : {i * step, -i * step}) {
+                const auto error          = std::abs(evaluate(middle, input).f - analyticCurve(input, gain));
+                accuracy.maxMidSliceError = juce::jmax(accuracy.maxMidSliceError, error);
+            }
+        }
+    }
+
+    return accuracy;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+/**
+ * Greg's transfer curve with antiderivative anti-aliasing (ADAA), first or second order.
+ *
+ * Instead of f(x[n]) the first order shaper outputs the mean of f between x[n-1] and x[n], (F1(x[n]) - F1(x[n-1])) /
+ * (x[n] - x[n-1]), which suppresses aliasing much like an extra oversampling stage and costs half a sample of delay.
+ * The second order shaper averages twice using F2 and delays by one sample. Where the divided differences become
+ * ill-conditioned (consecutive inputs closer than kTolerance) the shaper falls back to the curve at the midpoint.
+ *
+ * The curve has no closed-form antiderivatives, so f, F1 and F2 are tabulated in double precision over input
+ * amplitude x drive, one slice per 0.1 dB like WaveshaperTable. F1 and F2 are read with cubic Hermite interpolation,
+ * using the tabulated lower antiderivative as the slope, which keeps the divided differences smooth. A ramping drive
+ * between slices is interpolated across the four nearest at the same driven input, see measureAccuracy(). Beyond
+ * 9/d + 0.3 the curve is +-1 and both antiderivatives continue analytically. The table is about 7.4 MB, built once
+ * by buildTable() and shared by every instance in the process.
+ *
+ * Per-channel history lives in the shaper, so prepare() it for the channel count and reset() it whenever the signal
+ * it saw last is no longer the one that continues, e.g. after switching oversampling factor.
+ */
+class AntiderivativeShaper {
+public:
+    static constexpr double kTolerance = 1.0e-5;
+
+    /** Builds the shared table. Not realtime safe, call it from a background or the message thread. */
+    static void buildTable();
+
+    /**
+     * Starts buildTable() on a background thread and returns straight away, isTableReady() turns true once it's done.
+     * Does nothing if the table is ready or already being built.
+     */
+    static void buildTableAsync();
+
+    /** Whether buildTable() has finished. process() must not be called before. */
+    static bool isTableReady();
+
+    void prepare(int numChannels);
+    void reset();
+
+    /** Shapes numSamples samples of one channel in place, driveDb holds one drive value in decibels per sample. */
+    template<typename SampleType>
+    void process(int channel, SampleType* data, const SampleType* driveDb, int numSamples, int order);
+
+    /** Shapes numSamples samples of one channel in place with a settled drive, in decibels. */
+    template<typename SampleType>
+    void process(int channel, SampleType* data, float driveDb, int numSamples, int order);
+
+    /**
+     * Compares the tabulated curve and first antiderivative against the analytic ones in double precision, for
+     * inputs in [-12, 12] on every slice, and the curve half way between slices, where ramps read it from four.
+     * Reports the largest absolute differences.
+     */
+    struct Accuracy {
+        double maxCurveError    = 0.0;
+        double maxFirstError    = 0.0;
+        double maxMidSliceError = 0.0;  // The curve half way between slices
+    };
+
+    static Accuracy measureAccuracy();
+
+private:
+    struct History {
+        double x1 = 0.0;  // Previous input
+        double x2 = 0.0;  // The one before
+        double d1 = 0.0;  // Second order: the previous first divided difference of F2
+    };
+
+    std::vector<History> mHistory;
+};
@@ -0,0 +1,100 @@
+#include "BlockSmoother.hpp"
+
+void BlockSmoother::reset(double sampleRate, double rampLengthSeconds) {
+    jassert(sampleRate > 0.0 && rampLengthSeconds >= 0.0);
+    mStepsToTarget = static_cast<int>(std::floor(rampLengthSeconds * sampleRate));
+    setCurrentAndTargetValue(mTarget);
+}
+
+void BlockSmoother::setSampleRate(double sampleRate, double rampLengthSeconds) {
+    jassert(sampleRate > 0.0 && rampLengthSeconds >= 0.0);
+    mStepsToTarget = static_cast<int>(std::floor(rampLengthSeconds * sampleRate));
+    if (isSmoothing()) rampTo(mTarget, mStepsToTarget);
+}
+
+void BlockSmoother::setCurrentAndTargetValue(float newValue) {
+    mCurrent   = newValue;
+    mTarget    = newValue;
+    mCountdown = 0;
+}
+
+void BlockSmoother::setTargetValue(float newValue) {
+    if (newValue == mTarget) return;
+
+    rampTo(newValue, mStepsToTarget);
+}
+
+void BlockSmoother::rampTo(float newValue, int numSteps) {
+    if (numSteps <= 0 || (newValue == mTarget && !isSmoothing())) {
+        setCurrentAndTargetValue(newValue);
+        return;
+    }
+
+    mTarget    = newValue;
+    mCountdown = numSteps;
+    mStep      = (mTarget - mCurrent) / static_cast<float>(mCountdown);
+}
+
+void BlockSmoother::skip(int numSamples) {
+    if (numSamples >= mCountdown) {
+        setCurrentAndTargetValue(mTarget);
+        return;
+    }
+
+    mCurrent += mStep * static_cast<float>(numSamples);
+    mCountdown -= numSamples;
+}
+
+template<typename SampleType>
+void BlockSmoother::render(SampleType* destination, int numSamples) {
+    const int rampLength = juce::jmin(numSamples, mCountdown);
+
+    // Closed form instead of an accumulating add, so the loop has no dependency chain
+    for (int i = 0; i < rampLength; ++i) {
+        destination[i] = mCurrent + mStep * static_cast<float>(i + 1);
+    }
+
+    if (rampLength == mCountdown) {
+        if (rampLength > 0) destination[rampLength - 1] = mTarget;
+        juce::FloatVectorOperations::fill(destination + rampLength, SampleType(mTarget), numSamples - rampLength);
+    }
+
+    skip(numSamples);
+}
+
+template<typename SampleType>
+void BlockSmoother::renderDecibelsToGain(SampleType* destination, int numSamples) {
+    const int rampLength = juce::jmin(numSamples, mCountdown);
+
+    if (rampLength > 0) {
+        // A linear ramp in dB is a geometric series in gain: every sample multiplies by the same ratio
+        std::array<SampleType, kAnchorInterval> ratioPowers;
+        const double ratio = std::pow(10.0, mStep * 0.05);
+        double power       = 1.0;
+        for (auto& ratioPower : ratioPowers) {
+            power *= ratio;
+            ratioPower = static_cast<SampleType>(power);
+        }
+
+        for (int anchor = 0; anchor < rampLength; anchor += kAnchorInterval) {
+            const auto anchorDb = mCurrent + mStep * static_cast<float>(anchor);
+            juce::FloatVectorOperations::multiply(destination + anchor,
+                                                  ratioPowers.data(),
+                                                  static_cast<SampleType>(juce::Decibels::decibelsToGain(anchorDb)),
+                                                  juce::jmin(kAnchorInterval, rampLength - anchor));
+        }
+    }
+
+    if (rampLength == mCountdown) {
+        const auto targetGain = static_cast<SampleType>(juce::Decibels::decibelsToGain(mTarget));
+        if (rampLength > 0) destination[rampLength - 1] = targetGain;
+        juce::FloatVectorOperations::fill(destination + rampLength, targetGain, numSamples - rampLength);
+    }
+
+    skip(numSamples);
+}
+
+template void BlockSmoother::render(float*, int);
+template void BlockSmoother::render(double*, int);
+template void BlockSmoother::renderDecibelsToGain(float*, int);
+template void BlockSmoother::renderDecibelsToGain(double*, int);
@@ -0,0 +1,83 @@
+#include "EditorAssets.hpp"
+#include "BinaryData.h"
+
+JUCE_IMPLEMENT_SINGLETON(EditorAssets)
+
+namespace {
+    struct Resource {
+        const char* data;
+        int size;
+    };
+
+    // In the order of EditorAssets::Image
+    const std::array<Resource, EditorAssets::kNumImages> kResources {{
+      {BinaryData::bg1x_png, BinaryData::bg1x_pngSize},
+      {BinaryData::power_btn1x_png, BinaryData::power_btn1x_pngSize},
+      {BinaryData::left_arrow1x_png, BinaryData::left_arrow1x_pngSize},
+      {BinaryData::right_arrow1x_png, BinaryData::right_arrow1x_pngSize},
+      {BinaryData::pre_off1x_png, BinaryData::pre_off1x_pngSize},
+      {BinaryData::pre_on1x_png, BinaryData::pre_on1x_pngSize},
+    }};
+}  // namespace
+
+EditorAssets::EditorAssets() : juce::Thread("Greg editor assets") {}
+
+EditorAssets::~EditorAssets() {
+    stopThread(-1);
+    clearSingletonInstance();
+}
+
+void EditorAssets::loadAsync(int backgroundWidth, int backgroundHeight) {
+    JUCE_ASSERT_MESSAGE_THREAD
+    if (isReady() || isThreadRunning()) return;
+
+    mPrefetchWidth  = backgroundWidth;
+    mPrefetchHeight = backgroundHeight;
+    startThread();
+}
+
+juce::Image EditorAssets::getScaled(Image image, int width, int height) {
+    JUCE_ASSERT_MESSAGE_THREAD
+    jassert(isReady());
+
+    const auto cached = std::find_if(mScaledImages.begin(), mScaledImages.end(), [&](const ScaledImage& scaled) {
+        return scaled.source == image && scaled.width == width && scaled.height == height;
+    });
+
+    if (cached != mScaledImages.end()) {
+        std::rotate(mScaledImages.begin(), cached, cached + 1);
+        return mScaledImages.front().image;
+    }
+
+    if (static_cast<int>(mScaledImages.size()) >= kMaxScaledImages) mScaledImages.pop_back();
+
+    auto scaled = resample(get(image), width, height);
+    mScaledImages.insert(mScaledImages.begin(), ScaledImage {image, width, height, std::move(scaled)});
+    return mScaledImages.front().image;
+}
+
+void EditorAssets::run() {
+    for (size_t i = 0; i < kResources.size(); ++i) {
+        if (threadShouldExit()) return;
+
+        // Software images, so decoding and resampling here never touch the platform's graphics context
+        const auto& resource = kResources[i];
+        const auto decoded   = juce::ImageFileFormat::loadFrom(resource.data, static_cast<size_t>(resource.size));
+        mImages[i]           = juce::SoftwareImageType().convert(decoded);
+    }
+
+    if (mPrefetchWidth > 0 && mPrefetchHeight > 0 && !threadShouldExit()) {
+        const auto& background = get(Image::background);
+        mScaledImages.push_back({Image::background,
+                                 mPrefetchWidth,
+                                 mPrefetchHeight,
+                                 resample(background, mPrefetchWidth, mPrefetchHeight)});
+    }
+
+    mReady.store(true, std::memory_order_release);
+}
+
+juce::Image EditorAssets::resample(const juce::Image& image, int width, int height) {
+    if (image.getWidth() == width && image.getHeight() == height) return image;
+    return image.rescaled(width, height, juce::Graphics::highResamplingQuality);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+/**
+ * The editor's artwork, decoded once per process and shared by every editor.
+ *
+ * The first loadAsync() decodes the PNGs from BinaryData on a background thread, so opening an editor never waits
+ * for them. Until isReady() the editor paints a placeholder. Resampled copies for a given size in physical pixels
+ * (the logical size times the display scale) are kept in a small most-recently-used cache, so editors on the same
+ * display share one high quality resample and moving to a display with another scale costs one more. The size the
+ * first editor asks for is resampled on the decoding thread too.
+ *
+ * Deleted when JUCE shuts down, after the decoding thread has finished.
+ */
+class EditorAssets : public juce::DeletedAtShutdown,
+                     private juce::Thread {
+public:
+    enum class Image { background, powerButton, leftArrow, rightArrow, preOff, preOn };
+
+    static constexpr int kNumImages       = 6;
+    static constexpr int kMaxScaledImages = 4;
+
+    ~EditorAssets() override;
+
+    /**
+     * Starts decoding unless that already happened. The background is also resampled to backgroundWidth x
+     * backgroundHeight physical pixels on the decoding thread. Message thread only.
+     */
+    void loadAsync(int backgroundWidth, int backgroundHeight);
+
+    /** Whether every image has been decoded. Can be called from any thread. */
+    bool isReady() const {
+        return mReady.load(std::memory_order_acquire);
+    }
+
+    /** An image at its original size. Only valid once isReady(). */
+    const juce::Image& get(Image image) const {
+        return mImages[static_cast<size_t>(image)];
+    }
+
+    /** An image resampled to width x height physical pixels, from the cache if possible. Message thread only. */
+    juce::Image getScaled(Image image, int width, int height);
+
+    JUCE_DECLARE_SINGLETON(EditorAssets, false)
+
+private:
+    EditorAssets();
+
+    struct ScaledImage {
+        Image source;
+        int width;
+        int height;
+        juce::Image image;
+    };
+
+    std::atomic<bool> mReady {false};
+    std::array<juce::Image, kNumImages> mImages;
+
+    // Most recently used first. Written by the decoding thread until mReady, then by the message thread only.
+    std::vector<ScaledImage> mScaledImages;
+
+    int mPrefetchWidth  = 0;
+    int mPrefetchHeight = 0;
+
+    void run() override;
+    static juce::Image resample(const juce::Image& image, int width, int height);
+};
@@ -0,0 +1,688 @@
+#include "GregEngine.hpp"
+
+namespace {
+    // Halved on the way in, so decoding is a plain sum and difference
+    template<typename SampleType>
+    void encodeMidSide(SampleType* left, SampleType* right, int numSamples) {
+        for (int i = 0; i < numSamples; ++i) {
+            const auto mid  = (left[i] + right[i]) * SampleType(0.5);
+            const auto side = (left[i] - right[i]) * SampleType(0.5);
+            left[i]         = mid;
+            right[i]        = side;
+        }
+    }
+
+    template<typename SampleType>
+    void decodeMidSide(SampleType* mid, SampleType* side, int numSamples) {
+        for (int i = 0; i < numSamples; ++i) {
+            const auto left  = mid[i] + side[i];
+            const auto right = mid[i] - side[i];
+            mid[i]           = left;
+            side[i]          = right;
+        }
+    }
+}  // namespace
+
+template<typename SampleType>
+void GregEngine<SampleType>::prepare(double sampleRate,
+                                     int numChannels,
+                                     int maximumBlockSize,
+                                     const Parameters& parameters,
+                                     bool isNonRealtime) {
+    mSampleRate = sampleRate;
+    mParameters = parameters;
+
+    // Build every quality setting for both modes now, so process() can switch between them without allocating.
+    // Realtime stays lean with the shorter filters, offline renders get the steeper max quality ones.
+    mRealtimeOversampling.prepare(numChannels, maximumBlockSize, false);
+    mOfflineOversampling.prepare(numChannels, maximumBlockSize, true);
+
+    mProcessingMode = isNonRealtime ? ProcessingMode::offline : ProcessingMode::realtime;
+    getActiveOversampling().select(getSelectedOversamplingOrder(parameters), parameters.filterType);
+
+    mMultiband.prepare(sampleRate, numChannels, maximumBlockSize);
+    mMultiband.configure(parameters.bands, getSelectedOversamplingOrder(parameters), parameters.filterType);
+
+    const auto maxOversampledBlockSize = static_cast<size_t>(maximumBlockSize) << OversamplerBankBase::kMaxOrder;
+    mDriveCurve.assign(maxOversampledBlockSize, 1.0f);
+    mOutputCurve.assign(maxOversampledBlockSize, 1.0f);
+    mSideDriveCurve.assign(maxOversampledBlockSize, 1.0f);
+    mChannelPointers.assign(static_cast<size_t>(numChannels), nullptr);
+    mBypassActiveGains.assign(static_cast<size_t>(maximumBlockSize), 1.0f);
+    mBypassDryGains.assign(static_cast<size_t>(maximumBlockSize), 0.0f);
+
+    // Dry path: allocated once here, delayed by the wet path's latency so dry and wet line up
+    mDryBuffer.setSize(numChannels, maximumBlockSize, false, true, false);
+
+    juce::dsp::ProcessSpec drySpec {};
+    drySpec.sampleRate       = sampleRate;
+    drySpec.maximumBlockSize = static_cast<juce::uint32>(maximumBlockSize);
+    drySpec.numChannels      = static_cast<juce::uint32>(numChannels);
+
+    const auto maxLatency = juce::jmax({mRealtimeOversampling.getMaxLatencyInSamples(),
+                                        mOfflineOversampling.getMaxLatencyInSamples(),
+                                        mMultiband.getMaxLatencyInSamples()});
+    mDryDelay.setMaximumDelayInSamples(maxLatency + 1);  // The second order anti-aliased shaper adds up to one sample
+    mDryDelay.prepare(drySpec);
+
+    mToneFilter.prepare(numChannels, sampleRate);
+    mAntiderivativeShaper.prepare(numChannels);
+    mTelemetry.prepare(sampleRate);
+
+    // Start from the current parameter values
+    mDriveSmoothed.setCurrentAndTargetValue(parameters.drive);
+    mToneSmoothed.setCurrentAndTargetValue(parameters.tone);
+    mMixSmoothed.setCurrentAndTargetValue(parameters.mix);
+    mOutputSmoothed.setCurrentAndTargetValue(parameters.output);
+    mSideDriveSmoothed.setCurrentAndTargetValue(parameters.sideDrive);
+
+    mBypassStep     = static_cast<float>(1.0 / (kBypassFadeSeconds * sampleRate));
+    mBypassState    = parameters.isBypassed ? BypassState::bypassed : BypassState::active;
+    mBypassPosition = parameters.isBypassed ? 1.0f : 0.0f;
+
+    mSilentSamples = 0;
+    mIsSleeping    = false;
+
+    updateOversamplingState();
+}
+
+template<typename SampleType>
+bool GregEngine<SampleType>::process(juce::AudioBuffer<SampleType>& buffer,
+                                     const Parameters& parameters,
+                                     bool isNonRealtime,
+                                     Transition transition) {
+    juce::ScopedNoDenormals noDenormals;
+
+    mTelemetry.beginBlock(buffer);
+
+    // Hosts flag bounces through isNonRealtime(), which can flip without another prepareToPlay
+    const auto processingMode = isNonRealtime ? ProcessingMode::offline : ProcessingMode::realtime;
+    const bool modeChanged    = processingMode != mProcessingMode;
+    mProcessingMode           = processingMode;
+
+    auto& oversampling = getActiveOversampling();
+    if (modeChanged) oversampling.reset();
+
+    // A single comparison tells whether anything needs re-targeting, a steady block goes straight to the audio
+    const bool parametersChanged = modeChanged || transition != Transition::smoothed || parameters != mParameters;
+    bool latencyChanged          = false;
+
+    if (parametersChanged) {
+        // The shaper's history belongs to the order and the signals (left/right or mid/side) that wrote it
+        if (parameters.antialiasingOrder != mParameters.antialiasingOrder
+            || parameters.stereoMode != mParameters.stereoMode) {
+            mAntiderivativeShaper.reset();
+        }
+
+        // Switching between the full band and the band split swaps the whole wet path
+        const bool bandsToggled = isMultiband(parameters) != isMultiband(mParameters);
+        mParameters             = parameters;
+
+        const auto order             = getSelectedOversamplingOrder(parameters);
+        const bool bandLatencyChanged = mMultiband.configure(parameters.bands, order, parameters.filterType);
+
+        latencyChanged = oversampling.select(order, parameters.filterType) || modeChanged || bandsToggled
+                      || (isMultiband(parameters) && bandLatencyChanged);
+        if (latencyChanged) updateOversamplingState();
+        else updateTail();  // The crossovers may have moved
+
+        if (transition == Transition::withinBlock) {
+            // One ramp across the whole block (the smoothers tick at the wet path's rate), so a preset lands
+            // click-free but without the usual lag
+            const auto numSteps = buffer.getNumSamples() * getWetPathFactor();
+            mDriveSmoothed.rampTo(parameters.drive, numSteps);
+            mToneSmoothed.rampTo(parameters.tone, numSteps);
+            mMixSmoothed.rampTo(parameters.mix, numSteps);
+            mOutputSmoothed.rampTo(parameters.output, numSteps);
+            mSideDriveSmoothed.rampTo(parameters.sideDrive, numSteps);
+        } else {
+            // Smoothers ignore targets they already have
+            mDriveSmoothed.setTargetValue(parameters.drive);
+            mToneSmoothed.setTargetValue(parameters.tone);
+            mMixSmoothed.setTargetValue(parameters.mix);
+            mOutputSmoothed.setTargetValue(parameters.output);
+            mSideDriveSmoothed.setTargetValue(parameters.sideDrive);
+        }
+    }
+
+    // The anti-aliased shaper's table can finish building between parameter changes, its delay arrives with it
+    if (getActiveAntialiasingOrder() != mAntialiasingOrder) {
+        updateOversamplingState();
+        latencyChanged = true;
+    }
+
+    Block ioBlock(buffer);
+
+    // Fully bypassed only the dry delay runs, so the output keeps the latency the host compensates for
+    if (updateBypassState(parameters)) {
+        if (mDryDelay.getDelay() > 0) mDryDelay.process(juce::dsp::ProcessContextReplacing<SampleType>(ioBlock));
+        mTelemetry.endBlock(buffer);
+        return latencyChanged;
+    }
+
+    // Silence that has outlasted the tail can only produce silence. The chain sleeps from its first such block and
+    // wakes from cleared filters, exactly as if it had processed the zeros.
+    if (updateSilence(buffer)) {
+        if (!mIsSleeping) enterSleep(parameters);
+        buffer.clear();
+        mTelemetry.endBlock(buffer);
+        return latencyChanged;
+    }
+
+    // Hosts may exceed the block size announced in prepareToPlay, so work in chunks that fit the dry buffer
+    const auto maxChunkSize = static_cast<size_t>(mDryBuffer.getNumSamples());
+    jassert(maxChunkSize > 0);  // prepare() hasn't been called
+    if (maxChunkSize == 0) {
+        mTelemetry.endBlock(buffer);
+        return latencyChanged;
+    }
+
+    for (size_t offset = 0; offset < ioBlock.getNumSamples(); offset += maxChunkSize) {
+        auto chunk = ioBlock.getSubBlock(offset, juce::jmin(maxChunkSize, ioBlock.getNumSamples() - offset));
+        processChunk(chunk, parameters.isFilterPre);
+    }
+
+    mTelemetry.endBlock(buffer);
+    return latencyChanged;
+}
+
+template<typename SampleType>
+void GregEngine<SampleType>::processChunk(Block& block, bool isFilterPre) {
+    using Stage = Telemetry::Stage;
+
+    // Store dry signal for mixing, delayed to match the oversampling latency
+    auto dryBlock = Block(mDryBuffer).getSubBlock(0, block.getNumSamples());
+    {
+        Telemetry::ScopedStage stage(mTelemetry, Stage::mix);
+        dryBlock.copyFrom(block);
+        mDryDelay.process(juce::dsp::ProcessContextReplacing<SampleType>(dryBlock));
+    }
+
+    // Keep the mix smoother in step with the wet path's rate, tone advances inside applyToneFilter
+    const float mixStart = mMixSmoothed.getCurrentValue() * 0.01f;
+
+    if (isMultiband(mParameters)) shapeBands(block, isFilterPre);
+    else shapeOversampled(block, isFilterPre);
+
+    // Apply dry/wet mixing at original sample rate
+    Telemetry::ScopedStage mixStage(mTelemetry, Stage::mix);
+    const float mixEnd = mMixSmoothed.getCurrentValue() * 0.01f;
+
+    // A moving mix is interpolated across the chunk, so a preset change crossfades instead of stepping
+    const auto mixStep = (mixEnd - mixStart) / static_cast<float>(block.getNumSamples());
+
+    for (int channel = 0; channel < block.getNumChannels(); ++channel) {
+        auto* wetData = block.getChannelPointer(channel);
+        auto* dryData = dryBlock.getChannelPointer(channel);
+
+        for (int sample = 0; sample < block.getNumSamples(); ++sample) {
+            const float mixRatio = mixStart + mixStep * static_cast<float>(sample + 1);
+            wetData[sample]      = wetData[sample] * mixRatio + dryData[sample] * (1.0f - mixRatio);
+        }
+    }
+
+    if (mBypassState != BypassState::active) applyBypassFade(block, dryBlock);
+}
+
+template<typename SampleType>
+void GregEngine<SampleType>::shapeOversampled(Block& block, bool isFilterPre) {
+    using Stage = Telemetry::Stage;
+
+    auto& oversampler = getActiveOversampling().getCurrent();
+
+    // Get oversampled block
+    auto oversampledBlock = [&] {
+        Telemetry::ScopedStage stage(mTelemetry, Stage::upsample);
+        return oversampler.processSamplesUp(block);
+    }();
+
+    const auto numSamples = static_cast<int>(oversampledBlock.getNumSamples());
+
+    // Offline renders can afford the exact transcendental functions
+    const bool isOffline      = mProcessingMode == ProcessingMode::offline;
+    const auto saturationMode = isOffline ? SaturationKernel::Mode::scalar : mSaturationMode.load();
+
+    const auto numChannels = oversampledBlock.getNumChannels();
+    const auto stereoMode  = getStereoMode(mParameters, numChannels);
+    const bool isMidSide   = stereoMode == StereoMode::midSide;
+    const bool isLinked    = stereoMode == StereoMode::linked;
+
+    // Settled parameters are applied as constants, only a moving one is rendered into a curve (once for all channels)
+    const bool driveMoving  = isMidSide ? mDriveSmoothed.isSmoothing() || mSideDriveSmoothed.isSmoothing()
+                                        : mDriveSmoothed.isSmoothing();
+    const bool outputMoving = mOutputSmoothed.isSmoothing();
+
+    const auto settledDriveDb = mDriveSmoothed.getTargetValue();
+    const auto settledOffset  = mSideDriveSmoothed.getTargetValue();
+    const auto settledSideDb  = juce::jlimit(0.0f, kMaxDriveDb, settledDriveDb + settledOffset);
+
+    // The anti-aliased shaper takes precedence over the table and the kernel, until their tables are ready the curve
+    // is evaluated directly. Linking needs every channel at once, which only the kernel does. The waveshaper table
+    // only holds the parameter's 0.1 dB steps, so a ramping drive goes to the kernel too.
+    const auto antialiasingOrder  = mAntialiasingOrder;
+    const bool useAntiderivatives = antialiasingOrder > 0 && !isLinked;
+
+    const bool canUseTable = std::is_same_v<SampleType, float> && mParameters.useWaveshaperTable && !isOffline
+                          && WaveshaperTable::isReady();
+    const bool isOnSlice   = WaveshaperTable::isOnSlice(settledDriveDb)
+                          && (!isMidSide || WaveshaperTable::isOnSlice(settledSideDb));
+    const bool useTable    = canUseTable && isOnSlice && !driveMoving && !useAntiderivatives && !isLinked;
+
+    const bool isDriveInDecibels = useTable || useAntiderivatives;
+
+    mMixSmoothed.skip(numSamples);
+
+    // Tone filter, in front of the shaper when 'pre' is on
+    if (isFilterPre) applyToneFilter(oversampledBlock);
+
+    {
+        Telemetry::ScopedStage stage(mTelemetry, Stage::shape);
+
+        // The tables are indexed by drive in decibels, the kernel takes linear gain
+        if (isMidSide && driveMoving) {
+            renderMidSideDrives(numSamples, isDriveInDecibels);
+        } else if (driveMoving) {
+            if (isDriveInDecibels) mDriveSmoothed.render(mDriveCurve.data(), numSamples);
+            else mDriveSmoothed.renderDecibelsToGain(mDriveCurve.data(), numSamples);
+        }
+        if (!isMidSide) mSideDriveSmoothed.skip(numSamples);
+        if (outputMoving) mOutputSmoothed.renderDecibelsToGain(mOutputCurve.data(), numSamples);
+
+        const auto settledDrive  = useTable ? settledDriveDb : juce::Decibels::decibelsToGain(settledDriveDb);
+        const auto settledSide   = useTable ? settledSideDb : juce::Decibels::decibelsToGain(settledSideDb);
+        const auto settledOutput = juce::Decibels::decibelsToGain(mOutputSmoothed.getTargetValue());
+
+        // In mid/side channel 1 carries the side signal, and with it the side drive
+        const auto shapeChannel = [&](size_t channel) {
+            auto* channelData      = oversampledBlock.getChannelPointer(channel);
+            const bool isSide      = isMidSide && channel == 1;
+            const auto* driveCurve = isSide ? mSideDriveCurve.data() : mDriveCurve.data();
+            const auto driveDb     = isSide ? settledSideDb : settledDriveDb;
+            const auto drive       = isSide ? settledSide : settledDrive;
+
+            if (useAntiderivatives) {
+                const auto index = static_cast<int>(channel);
+                if (driveMoving) {
+                    mAntiderivativeShaper.process(index, channelData, driveCurve, numSamples, antialiasingOrder);
+                } else {
+                    mAntiderivativeShaper.process(index, channelData, driveDb, numSamples, antialiasingOrder);
+                }
+            } else if (useTable) {
+                // Only ever at a settled drive, see above
+                if constexpr (std::is_same_v<SampleType, float>) {
+                    constexpr auto interpolation = WaveshaperTable::Interpolation::cubic;
+                    WaveshaperTable::getInstance().process(channelData, drive, numSamples, interpolation);
+                }
+            } else if (driveMoving) {
+                SaturationKernel::process(channelData, driveCurve, numSamples, saturationMode);
+            } else {
+                SaturationKernel::process(channelData, SampleType(drive), numSamples, saturationMode);
+            }
+        };
+
+        // Apply saturation
+        if (isLinked) {
+            const auto numLinked = juce::jmin(numChannels, mChannelPointers.size());
+            for (size_t channel = 0; channel < numLinked; ++channel) {
+                mChannelPointers[channel] = oversampledBlock.getChannelPointer(channel);
+            }
+
+            const auto count = static_cast<int>(numLinked);
+            if (driveMoving) {
+                SaturationKernel::processLinked(mChannelPointers.data(),
+                                                count,
+                                                mDriveCurve.data(),
+                                                numSamples,
+                                                saturationMode);
+            } else {
+                SaturationKernel::processLinked(mChannelPointers.data(),
+                                                count,
+                                                SampleType(settledDrive),
+                                                numSamples,
+                                                saturationMode);
+            }
+        } else if (isMidSide && !isDriveInDecibels) {
+            // Encoding, shaping and decoding in one pass over the pair
+            auto* left  = oversampledBlock.getChannelPointer(0);
+            auto* right = oversampledBlock.getChannelPointer(1);
+
+            if (driveMoving) {
+                SaturationKernel::processMidSide(left,
+                                                 right,
+                                                 mDriveCurve.data(),
+                                                 mSideDriveCurve.data(),
+                                                 numSamples,
+                                                 saturationMode);
+            } else {
+                SaturationKernel::processMidSide(left,
+                                                 right,
+                                                 SampleType(settledDrive),
+                                                 SampleType(settledSide),
+                                                 numSamples,
+                                                 saturationMode);
+            }
+        } else if (isMidSide) {
+            // The anti-aliased shaper and the table keep per channel state or lookups, so they see mid and side as
+            // two channels
+            auto* left  = oversampledBlock.getChannelPointer(0);
+            auto* right = oversampledBlock.getChannelPointer(1);
+
+            encodeMidSide(left, right, numSamples);
+            shapeChannel(0);
+            shapeChannel(1);
+            decodeMidSide(left, right, numSamples);
+        } else {
+            for (size_t channel = 0; channel < numChannels; ++channel) shapeChannel(channel);
+        }
+
+        // Apply output gain
+        for (size_t channel = 0; channel < numChannels; ++channel) {
+            auto* channelData = oversampledBlock.getChannelPointer(channel);
+
+            if (outputMoving) {
+                juce::FloatVectorOperations::multiply(channelData, mOutputCurve.data(), numSamples);
+            } else if (settledOutput != 1.0f) {
+                juce::FloatVectorOperations::multiply(channelData, SampleType(settledOutput), numSamples);
+            }
+        }
+    }
+
+    if (!isFilterPre) applyToneFilter(oversampledBlock);
+
+    // Downsample back to original rate
+    {
+        Telemetry::ScopedStage stage(mTelemetry, Stage::downsample);
+        oversampler.processSamplesDown(block);
+    }
+}
+
+template<typename SampleType>
+void GregEngine<SampleType>::renderMidSideDrives(int numSamples, bool isDriveInDecibels) {
+    auto* mid  = mDriveCurve.data();
+    auto* side = mSideDriveCurve.data();
+
+    // Both are summed in decibels first, the side drive clamped to the range the tables cover
+    if (mDriveSmoothed.isSmoothing()) mDriveSmoothed.render(mid, numSamples);
+    else std::fill(mid, mid + numSamples, static_cast<SampleType>(mDriveSmoothed.getTargetValue()));
+
+    if (mSideDriveSmoothed.isSmoothing()) mSideDriveSmoothed.render(side, numSamples);
+    else std::fill(side, side + numSamples, static_cast<SampleType>(mSideDriveSmoothed.getTargetValue()));
+
+    for (int i = 0; i < numSamples; ++i) {
+        side[i] = juce::jlimit(SampleType(0), SampleType(kMaxDriveDb), mid[i] + side[i]);
+    }
+
+    if (isDriveInDecibels) return;
+
+    for (int i = 0; i < numSamples; ++i) {
+        mid[i]  = juce::Decibels::decibelsToGain(mid[i]);
+        side[i] = juce::Decibels::decibelsToGain(side[i]);
+    }
+}
+
+template<typename SampleType>
+void GregEngine<SampleType>::shapeBands(Block& block, bool isFilterPre) {
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+
+    // The band split runs at the base rate, each band oversamples itself inside MultibandSaturator
+    const bool isOffline      = mProcessingMode == ProcessingMode::offline;
+    const auto saturationMode = isOffline ? SaturationKernel::Mode::scalar : mSaturationMode.load();
+    mMixSmoothed.skip(numSamples);
+    mSideDriveSmoothed.skip(numSamples);  // The band split shapes every channel on its own
+
+    if (isFilterPre) applyToneFilter(block);
+
+    {
+        Telemetry::ScopedStage stage(mTelemetry, Telemetry::Stage::shape);
+
+        // The main drive reaches the bands in decibels, each adds its own offset before converting
+        const bool driveMoving = mDriveSmoothed.isSmoothing();
+        if (driveMoving) mDriveSmoothed.render(mDriveCurve.data(), numSamples);
+
+        const auto* driveCurve = driveMoving ? mDriveCurve.data() : nullptr;
+        mMultiband.process(block, driveCurve, mDriveSmoothed.getTargetValue(), saturationMode);
+
+        if (mOutputSmoothed.isSmoothing()) {
+            mOutputSmoothed.renderDecibelsToGain(mOutputCurve.data(), numSamples);
+            for (size_t channel = 0; channel < block.getNumChannels(); ++channel) {
+                auto* channelData = block.getChannelPointer(channel);
+                juce::FloatVectorOperations::multiply(channelData, mOutputCurve.data(), numSamples);
+            }
+        } else {
+            const auto settledOutput = juce::Decibels::decibelsToGain(mOutputSmoothed.getTargetValue());
+            if (settledOutput != 1.0f) block.multiplyBy(static_cast<SampleType>(settledOutput));
+        }
+    }
+
+    if (!isFilterPre) applyToneFilter(block);
+}
+
+template<typename SampleType>
+void GregEngine<SampleType>::applyBypassFade(Block& block, const Block& dryBlock) {
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+    const auto direction  = mBypassState == BypassState::fadingOut ? mBypassStep : -mBypassStep;
+    auto* activeGains     = mBypassActiveGains.data();
+    auto* dryGains        = mBypassDryGains.data();
+
+    // Equal power, so the level holds up half way even where the processed signal has drifted from the dry one. The
+    // position moves by a constant step, so the gains turn by a constant angle: one exact cos/sin pair per chunk
+    // anchors a rotation that runs in double precision. Once the fade reaches an end its gains are exact.
+    constexpr auto halfPi = juce::MathConstants<double>::halfPi;
+    const auto stepCos    = std::cos(direction * halfPi);
+    const auto stepSin    = std::sin(direction * halfPi);
+    auto activeGain       = std::cos(mBypassPosition * halfPi);
+    auto dryGain          = std::sin(mBypassPosition * halfPi);
+
+    for (int i = 0; i < numSamples; ++i) {
+        mBypassPosition = juce::jlimit(0.0f, 1.0f, mBypassPosition + direction);
+
+        if (mBypassPosition <= 0.0f || mBypassPosition >= 1.0f) {
+            activeGain = mBypassPosition <= 0.0f ? 1.0 : 0.0;
+            dryGain    = 1.0 - activeGain;
+        } else {
+            const auto rotated = activeGain * stepCos - dryGain * stepSin;
+            dryGain            = dryGain * stepCos + activeGain * stepSin;
+            activeGain         = rotated;
+        }
+
+        activeGains[i] = static_cast<SampleType>(activeGain);
+        dryGains[i]    = static_cast<SampleType>(dryGain);
+    }
+
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel) {
+        auto* output    = block.getChannelPointer(channel);
+        const auto* dry = dryBlock.getChannelPointer(channel);
+
+        for (int i = 0; i < numSamples; ++i) {
+            output[i] = output[i] * activeGains[i] + dry[i] * dryGains[i];
+        }
+    }
+
+    if (mBypassPosition <= 0.0f) mBypassState = BypassState::active;
+    else if (mBypassPosition >= 1.0f) mBypassState = BypassState::bypassed;
+}
+
+template<typename SampleType>
+bool GregEngine<SampleType>::updateBypassState(const Parameters& parameters) {
+    switch (mBypassState) {
+        case BypassState::active:
+            if (parameters.isBypassed) mBypassState = BypassState::fadingOut;
+            return false;
+        case BypassState::fadingOut:
+            if (!parameters.isBypassed) mBypassState = BypassState::fadingIn;
+            return false;
+        case BypassState::fadingIn:
+            if (parameters.isBypassed) mBypassState = BypassState::fadingOut;
+            return false;
+        case BypassState::bypassed:
+            if (parameters.isBypassed) return true;
+
+            // The wet path sat idle, start it from silence rather than from whatever it held when it stopped
+            resetWetPath(parameters);
+            mBypassState = BypassState::fadingIn;
+            return false;
+    }
+
+    return false;
+}
+
+template<typename SampleType>
+void GregEngine<SampleType>::resetWetPath(const Parameters& parameters) {
+    getActiveOversampling().reset();
+    mToneFilter.reset();
+    mAntiderivativeShaper.reset();
+    mMultiband.reset();
+
+    mDriveSmoothed.setCurrentAndTargetValue(parameters.drive);
+    mToneSmoothed.setCurrentAndTargetValue(parameters.tone);
+    mMixSmoothed.setCurrentAndTargetValue(parameters.mix);
+    mOutputSmoothed.setCurrentAndTargetValue(parameters.output);
+    mSideDriveSmoothed.setCurrentAndTargetValue(parameters.sideDrive);
+}
+
+template<typename SampleType>
+void GregEngine<SampleType>::applyToneFilter(Block& block) {
+    Telemetry::ScopedStage stage(mTelemetry, Telemetry::Stage::tone);
+
+    if (!mToneSmoothed.isSmoothing()) {
+        mToneFilter.setTone(mToneSmoothed.getTargetValue());
+        mToneFilter.process(block);
+        return;
+    }
+
+    // Step the coefficients along with the smoothed tone in short sub-blocks
+    for (size_t offset = 0; offset < block.getNumSamples(); offset += kToneUpdateInterval) {
+        const auto length = juce::jmin(kToneUpdateInterval, block.getNumSamples() - offset);
+        auto subBlock     = block.getSubBlock(offset, length);
+
+        mToneSmoothed.skip(static_cast<int>(length));
+        mToneFilter.setTone(mToneSmoothed.getCurrentValue());
+        mToneFilter.process(subBlock);
+    }
+}
+
+template<typename SampleType>
+bool GregEngine<SampleType>::updateSilence(const juce::AudioBuffer<SampleType>& buffer) {
+    const auto numSamples = buffer.getNumSamples();
+    const auto threshold  = getSilenceThreshold();
+
+    // getMagnitude() runs the vectorised FloatVectorOperations::findMinAndMax, the first loud channel ends the scan
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+        if (buffer.getMagnitude(channel, 0, numSamples) >= threshold) {
+            mSilentSamples = 0;
+            mIsSleeping    = false;
+            return false;
+        }
+    }
+
+    mSilentSamples += numSamples;
+    return mSilentSamples >= static_cast<juce::int64>(mTail.load()) + numSamples;
+}
+
+template<typename SampleType>
+float GregEngine<SampleType>::getSilenceThreshold() const {
+    // Near zero the curve is a straight line, the steepest the chain can get. The tone filter never boosts and the
+    // dry path has unity gain.
+    const auto driveDb  = juce::jmax(mDriveSmoothed.getCurrentValue(), mDriveSmoothed.getTargetValue());
+    const auto outputDb = juce::jmax(mOutputSmoothed.getCurrentValue(), mOutputSmoothed.getTargetValue());
+    const auto drive    = juce::Decibels::decibelsToGain(driveDb + getMaxDriveOffset());
+    const auto gain     = SaturationKernel::getSmallSignalGain(drive) * juce::Decibels::decibelsToGain(outputDb);
+
+    return kSilenceThreshold / juce::jmax(1.0f, gain);
+}
+
+template<typename SampleType>
+void GregEngine<SampleType>::enterSleep(const Parameters& parameters) {
+    mIsSleeping = true;
+
+    // Everything still held is below the threshold, clear it so waking up starts from true silence
+    resetWetPath(parameters);
+    mDryDelay.reset();
+
+    // Nothing audible is left to fade
+    if (mBypassState == BypassState::fadingIn) {
+        mBypassState    = BypassState::active;
+        mBypassPosition = 0.0f;
+    } else if (mBypassState == BypassState::fadingOut) {
+        mBypassState    = BypassState::bypassed;
+        mBypassPosition = 1.0f;
+    }
+}
+
+template<typename SampleType>
+int GregEngine<SampleType>::getSelectedOversamplingOrder(const Parameters& parameters) const {
+    if (mProcessingMode == ProcessingMode::realtime) return parameters.oversamplingOrder;
+
+    // Renders never drop below the realtime setting
+    return juce::jmax(parameters.oversamplingOrder, parameters.renderOversamplingOrder);
+}
+
+template<typename SampleType>
+int GregEngine<SampleType>::getWetPathFactor() const {
+    return isMultiband(mParameters) ? 1 : getActiveOversampling().getFactor();
+}
+
+template<typename SampleType>
+int GregEngine<SampleType>::getActiveAntialiasingOrder() const {
+    // Linking needs every channel at once, which only the kernel does, see shapeOversampled()
+    const auto numChannels = static_cast<size_t>(mDryBuffer.getNumChannels());
+    if (isMultiband(mParameters) || getStereoMode(mParameters, numChannels) == StereoMode::linked) return 0;
+    return AntiderivativeShaper::isTableReady() ? mParameters.antialiasingOrder : 0;
+}
+
+template<typename SampleType>
+float GregEngine<SampleType>::getMaxDriveOffset() const {
+    if (!isMultiband(mParameters)) {
+        if (mParameters.stereoMode != StereoMode::midSide) return 0.0f;
+        return juce::jmax(0.0f, mSideDriveSmoothed.getCurrentValue(), mSideDriveSmoothed.getTargetValue());
+    }
+
+    const auto& offsets = mParameters.bands.driveOffsets;
+    return juce::jmax(0.0f, *std::max_element(offsets.begin(), offsets.begin() + mParameters.bands.numBands));
+}
+
+template<typename SampleType>
+void GregEngine<SampleType>::updateOversamplingState() {
+    // The smoothers tick at the rate the wet path runs at, so their ramp length has to follow the factor. Ramps in
+    // progress carry on from where they are rather than snapping to their targets.
+    const double wetPathRate = mSampleRate * getWetPathFactor();
+
+    mDriveSmoothed.setSampleRate(wetPathRate, kSmoothingTimeSeconds);
+    mToneSmoothed.setSampleRate(wetPathRate, kSmoothingTimeSeconds);
+    mMixSmoothed.setSampleRate(wetPathRate, kSmoothingTimeSeconds);
+    mOutputSmoothed.setSampleRate(wetPathRate, kSmoothingTimeSeconds);
+    mSideDriveSmoothed.setSampleRate(wetPathRate, kSmoothingTimeSeconds);
+
+    mToneFilter.setSampleRate(wetPathRate);
+    mToneFilter.reset();
+    mAntiderivativeShaper.reset();
+    mMultiband.reset();
+
+    const auto latency = isMultiband(mParameters) ? mMultiband.getLatencyInSamples()
+                                                  : getActiveOversampling().getLatencyInSamples();
+    // The anti-aliased shaper delays by half a sample (first order) or a whole one (second order) at the wet path's
+    // rate. The dry path takes the fraction exactly, the host is told the total rounded to whole samples.
+    mAntialiasingOrder  = getActiveAntialiasingOrder();
+    const auto dryDelay = latency + 0.5 * mAntialiasingOrder / getWetPathFactor();
+
+    // The newly selected oversampler starts from silence, so the dry path does too. Keeping the old contents under
+    // the new delay would jump to a different point in the past and leave dry and wet out of line.
+    mDryDelay.setDelay(static_cast<SampleType>(dryDelay));
+    mDryDelay.reset();
+    mLatency = juce::roundToInt(dryDelay);
+
+    updateTail();
+}
+
+template<typename SampleType>
+void GregEngine<SampleType>::updateTail() {
+    const auto toneTail = juce::roundToInt(kToneTailSeconds * mSampleRate);
+
+    // The oversampling filters ring for up to twice their latency, the linear phase FIRs are that long. The band
+    // split adds its lowest crossover's decay.
+    if (isMultiband(mParameters)) mTail = mMultiband.getTailInSamples() + toneTail;
+    else mTail = 2 * mLatency.load() + toneTail;
+}
+
+template class GregEngine<float>;
+template class GregEngine<double>;
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+
+#include "AntiderivativeShaper.hpp"
+#include "BlockSmoother.hpp"
+#include "MultibandSaturator.hpp"
+#include "OversamplerBank.hpp"
+#include "SaturationKernel.hpp"
+#include "Telemetry.hpp"
+#include "ToneFilter.hpp"
+#include "WaveshaperTable.hpp"
+
+/**
+ * The parts of GregEngine that don't depend on the sample type: the parameter snapshot, the settings and the
+ * measurements. Lets the processor reach whichever precision the host runs without knowing which one it is.
+ */
+class GregEngineBase {
+public:
+    /**
+     * How the full band shaper treats a stereo pair. Dual shapes each channel on its own, mid/side shapes the sum and
+     * difference with separate drives, linked drives every channel with the gain the loudest one gets.
+     */
+    enum class StereoMode { dual, midSide, linked };
+
+    /** Parameter values in their natural units, the same ranges as the plugin parameters. */
+    struct Parameters {
+        float drive      = 0.0f;    // dB
+        float tone       = 100.0f;  // %
+        float mix        = 100.0f;  // %
+        float output     = 0.0f;    // dB
+        bool isFilterPre = false;
+        bool isBypassed  = false;  // Crossfades to the latency-aligned dry signal, then idles
+
+        int oversamplingOrder       = 1;  // 2^n times, used for realtime playback
+        int renderOversamplingOrder = 3;  // Used for offline renders, which never go below oversamplingOrder
+        int antialiasingOrder       = 0;  // 0 shapes directly, 1 or 2 with AntiderivativeShaper once its table is built
+
+        // Reads WaveshaperTable once it is built, for realtime float playback at a settled drive. Ramps, offline
+        // renders and the double precision engine keep evaluating the curve.
+        bool useWaveshaperTable = false;
+
+        // Mid/side needs exactly two channels and linking at least two, otherwise the channels are shaped on their own.
+        // Linked always uses the kernel, the anti-aliased and table shapers work per channel.
+        StereoMode stereoMode = StereoMode::dual;
+        float sideDrive       = 0.0f;  // dB on top of drive for the side signal, clamped to the drive range
+
+        // More than one band replaces the full band shaper (and ADAA) with MultibandSaturator
+        MultibandSaturatorBase::Settings bands;
+        OversamplerBankBase::FilterType filterType = OversamplerBankBase::FilterType::linearPhase;
+
+        bool operator==(const Parameters&) const = default;
+    };
+
+    /** How process() moves to new parameter values. */
+    enum class Transition {
+        smoothed,     // The regular short ramp, for automation and knob moves
+        withinBlock,  // Arrives by the end of this block, for preset changes
+    };
+
+    /** Latency of the current oversampling setting. Can be read from any thread. */
+    int getLatencyInSamples() const {
+        return mLatency.load();
+    }
+
+    /**
+     * How long the output keeps going after the input falls silent: the latency, the oversampling filters ringing out
+     * and the tone filter decaying. Can be read from any thread.
+     */
+    int getTailInSamples() const {
+        return mTail.load();
+    }
+
+    /** Switches between the exact scalar shaper and the SIMD approximation, e.g. to compare the two. */
+    void setSaturationMode(SaturationKernel::Mode mode) {
+        mSaturationMode = mode;
+    }
+
+    Telemetry& getTelemetry() {
+        return mTelemetry;
+    }
+
+    const Telemetry& getTelemetry() const {
+        return mTelemetry;
+    }
+
+protected:
+    std::atomic<int> mLatency {0};
+    std::atomic<int> mTail {0};
+
+    std::atomic<SaturationKernel::Mode> mSaturationMode {SaturationKernel::Mode::vectorized};
+
+    Telemetry mTelemetry;
+
+    static bool isMultiband(const Parameters& parameters) {
+        return parameters.bands.numBands > 1;
+    }
+
+    /** The stereo mode the full band shaper can run with numChannels channels. */
+    static StereoMode getStereoMode(const Parameters& parameters, size_t numChannels) {
+        if (parameters.stereoMode == StereoMode::midSide && numChannels != 2) return StereoMode::dual;
+        if (parameters.stereoMode == StereoMode::linked && numChannels < 2) return StereoMode::dual;
+        return parameters.stereoMode;
+    }
+};
+
+/**
+ * Greg's complete signal path: oversampling, tone filter, saturation, output gain and the latency-aligned dry/wet
+ * mix.
+ *
+ * Only depends on juce_dsp, so headless tools can render without pulling in the plugin or GUI modules. GregProcessor
+ * reads its parameters into a Parameters snapshot and hands the buffer over once per block. Instantiated for float
+ * and double, for hosts that mix in 64 bit.
+ */
+template<typename SampleType>
+class GregEngine : public GregEngineBase {
+public:
+    /** Allocates everything process() can need. The parameters, bypass included, are jumped to rather than smoothed. */
+    void prepare(double sampleRate,
+                 int numChannels,
+                 int maximumBlockSize,
+                 const Parameters& parameters,
+                 bool isNonRealtime);
+
+    /**
+     * Processes the buffer in place. Pass isNonRealtime for offline renders, which use the exact shaper and the
+     * steeper oversampling filters. Returns true if the latency changed, see getLatencyInSamples().
+     */
+    bool process(juce::AudioBuffer<SampleType>& buffer,
+                 const Parameters& parameters,
+                 bool isNonRealtime,
+                 Transition transition = Transition::smoothed);
+
+private:
+    static constexpr double kSmoothingTimeSeconds = 0.01;
+    // While tone moves, the filter coefficients are refreshed this often (in oversampled samples)
+    static constexpr size_t kToneUpdateInterval = 32;
+    static constexpr double kBypassFadeSeconds  = 0.02;
+    static constexpr float kMaxDriveDb          = 30.0f;  // The drive parameter range, side drive stays inside it
+
+    // Output level treated as silence (-120 dB), and the time the tone filter needs to decay below it from full
+    // scale at its lowest cutoff
+    static constexpr float kSilenceThreshold = 1.0e-6f;
+    static constexpr double kToneTailSeconds = 0.01;
+
+    using Block = juce::dsp::AudioBlock<SampleType>;
+
+    double mSampleRate = 44100;
+    Parameters mParameters;  // As of the last process() call
+
+    // Realtime playback and offline bounces (isNonRealtime()) run separately prepared oversamplers
+    enum class ProcessingMode { realtime, offline };
+
+    ProcessingMode mProcessingMode = ProcessingMode::realtime;
+    OversamplerBank<SampleType> mRealtimeOversampling;
+    OversamplerBank<SampleType> mOfflineOversampling;
+
+    // Consecutive silent input samples. Once they cover the tail the output is silent too and the chain sleeps.
+    juce::int64 mSilentSamples = 0;
+    bool mIsSleeping           = false;
+
+    // Dry path, sized in prepare() and delayed to line up with the oversampling filter latency plus the anti-aliased
+    // shaper's fractional delay. Thiran interpolation is an allpass, so the fraction costs the dry signal no treble.
+    juce::AudioBuffer<SampleType> mDryBuffer;
+    juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::Thiran> mDryDelay;
+
+    // Per-sample gain curves at the oversampled rate, shared by all channels, only filled while a ramp is running
+    std::vector<SampleType> mDriveCurve;
+    std::vector<SampleType> mOutputCurve;
+    std::vector<SampleType> mSideDriveCurve;  // Mid/side only, drive plus the side offset
+
+    // The oversampled block's channels, for the linked shaper
+    std::vector<SampleType*> mChannelPointers;
+
+    ToneFilter<SampleType> mToneFilter;
+    AntiderivativeShaper mAntiderivativeShaper;
+    int mAntialiasingOrder = 0;  // The order the anti-aliased shaper runs at, the dry delay includes its delay
+    MultibandSaturator<SampleType> mMultiband;
+
+    // Bypass runs active -> fadingOut -> bypassed and back through fadingIn. Fades can reverse half way, only the
+    // bypassed state skips the wet path and only leaving it resets the filters.
+    enum class BypassState { active, fadingOut, bypassed, fadingIn };
+
+    BypassState mBypassState = BypassState::active;
+    float mBypassPosition    = 0.0f;  // 0 fully active, 1 fully bypassed
+    float mBypassStep        = 0.0f;  // Per sample at the base rate
+
+    // The fade's gains over the current chunk, shared by all channels
+    std::vector<SampleType> mBypassActiveGains;
+    std::vector<SampleType> mBypassDryGains;
+
+    // Smoothed parameters
+    BlockSmoother mDriveSmoothed;
+    BlockSmoother mToneSmoothed;
+    BlockSmoother mMixSmoothed;
+    BlockSmoother mOutputSmoothed;
+    BlockSmoother mSideDriveSmoothed;  // The offset, in dB
+
+    void processChunk(Block& block, bool isFilterPre);
+    void shapeOversampled(Block& block, bool isFilterPre);
+    void shapeBands(Block& block, bool isFilterPre);
+
+    /**
+     * Fills the drive curves for mid/side: mid into mDriveCurve, mid plus the side offset into mSideDriveCurve, in
+     * decibels or as linear gain.
+     */
+    void renderMidSideDrives(int numSamples, bool isDriveInDecibels);
+    void applyToneFilter(Block& block);
+    void applyBypassFade(Block& block, const Block& dryBlock);
+
+    /** Moves the bypass state towards isBypassed. Returns true while the wet path can be skipped entirely. */
+    bool updateBypassState(const Parameters& parameters);
+    void resetWetPath(const Parameters& parameters);
+
+    /** Counts silent input. Returns true once this whole block's output is known to be silent. */
+    bool updateSilence(const juce::AudioBuffer<SampleType>& buffer);
+    float getSilenceThreshold() const;
+    void enterSleep(const Parameters& parameters);
+
+    OversamplerBank<SampleType>& getActiveOversampling() {
+        return mProcessingMode == ProcessingMode::offline ? mOfflineOversampling : mRealtimeOversampling;
+    }
+
+    const OversamplerBank<SampleType>& getActiveOversampling() const {
+        return mProcessingMode == ProcessingMode::offline ? mOfflineOversampling : mRealtimeOversampling;
+    }
+
+    int getSelectedOversamplingOrder(const Parameters& parameters) const;
+
+    /** 1 for the band split, which oversamples per band, otherwise the active oversampling factor. */
+    int getWetPathFactor() const;
+
+    /** The anti-aliasing order the full band shaper can run with now, 0 for the band split, linking or no table yet. */
+    int getActiveAntialiasingOrder() const;
+    float getMaxDriveOffset() const;
+
+    void updateOversamplingState();
+    void updateTail();
+};
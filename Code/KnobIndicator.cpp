@@ -14,27 +14,26 @@ void KnobIndicatorLookAndFeel::drawRotarySlider(juce::Graphics& g,
                                                 float rotaryEndAngle,
                                                 juce::Slider& slider) {
     auto bounds = juce::Rectangle<int>(x, y, width, height).toFloat();
-    auto centre = bounds.getCentre();
-    auto radius = juce::jmin(bounds.getWidth(), bounds.getHeight()) / 2.0f;
 
     // Calculate current angle
     auto angle = rotaryStartAngle + sliderPosProportional * (rotaryEndAngle - rotaryStartAngle);
 
-    // TODO: Also make these parameters
-    auto indicatorLength    = 20.0f;
-    auto indicatorThickness = 2.0f;
+    if (bounds != mCachedBounds || angle != mCachedAngle) {
+        auto centre = bounds.getCentre();
+        auto radius = juce::jmin(bounds.getWidth(), bounds.getHeight()) / 2.0f;
 
-    // Start point inset from the edge
-    auto indicatorStart =
-      centre.translated((radius - mInset - indicatorLength) * std::cos(angle - juce::MathConstants<float>::halfPi),
-                        (radius - mInset - indicatorLength) * std::sin(angle - juce::MathConstants<float>::halfPi));
+        // Unit direction of the indicator, pointing up at angle 0
+        const auto direction = juce::Point<float>(std::sin(angle), -std::cos(angle));
 
-    // End point inset from the edge
-    auto indicatorEnd = centre.translated((radius - mInset) * std::cos(angle - juce::MathConstants<float>::halfPi),
-                                          (radius - mInset) * std::sin(angle - juce::MathConstants<float>::halfPi));
+        // Start and end points inset from the edge
+        mCachedLine   = {centre + direction * (radius - mInset - kIndicatorLength),
+                         centre + direction * (radius - mInset)};
+        mCachedBounds = bounds;
+        mCachedAngle  = angle;
+    }
 
     g.setColour(juce::Colours::white.withAlpha(0.5f));
-    g.drawLine(indicatorStart.x, indicatorStart.y, indicatorEnd.x, indicatorEnd.y, indicatorThickness);
+    g.drawLine(mCachedLine, kIndicatorThickness);
 }
 
 KnobIndicator::KnobIndicator(float inset) {
@@ -47,4 +46,36 @@ KnobIndicator::KnobIndicator(float inset) {
 
 KnobIndicator::~KnobIndicator() {
     setLookAndFeel(nullptr);
+}
+
+void KnobIndicator::attachToParameter(juce::RangedAudioParameter& parameter) {
+    mParameter = &parameter;
+
+    const auto& range = parameter.getNormalisableRange();
+    setNormalisableRange({range.start, range.end, range.interval, range.skew});
+
+    // The same gestures SliderAttachment reports: a drag is one gesture, anything else (wheel, keys) one each
+    onDragStart   = [this] { mParameter->beginChangeGesture(); };
+    onDragEnd     = [this] { mParameter->endChangeGesture(); };
+    onValueChange = [this] {
+        const auto value = mParameter->convertTo0to1(static_cast<float>(getValue()));
+        if (isMouseButtonDown()) {
+            mParameter->setValueNotifyingHost(value);
+        } else {
+            mParameter->beginChangeGesture();
+            mParameter->setValueNotifyingHost(value);
+            mParameter->endChangeGesture();
+        }
+    };
+
+    syncToParameter();
+}
+
+void KnobIndicator::syncToParameter() {
+    // Mid-drag the knob is the source of the value, not the other way round
+    if (mParameter == nullptr || isMouseButtonDown()) return;
+
+    // Snapped like the slider snaps, so an unchanged value compares equal and doesn't repaint
+    const auto value = getNormalisableRange().snapToLegalValue(mParameter->convertFrom0to1(mParameter->getValue()));
+    if (value != getValue()) setValue(value, juce::dontSendNotification);
 }
\ No newline at end of file
@@ -23,7 +23,16 @@ public:
     }
 
 private:
+    // TODO: Also make these parameters
+    static constexpr float kIndicatorLength    = 20.0f;
+    static constexpr float kIndicatorThickness = 2.0f;
+
     float mInset {4.0f};
+
+    // The line last drawn, a repaint at the same bounds and angle (the background behind it changed) skips the trig
+    juce::Rectangle<float> mCachedBounds;
+    float mCachedAngle = 0.0f;
+    juce::Line<float> mCachedLine;
 };
 
 class KnobIndicator : public juce::Slider {
@@ -31,7 +40,18 @@ public:
     KnobIndicator(float inset);
     ~KnobIndicator() final;
 
+    /**
+     * Binds the knob to a parameter, taking over its range. Drags write through to the parameter straight away, but
+     * the knob only follows the parameter in syncToParameter(), so host automation can't repaint it any faster than
+     * that is called.
+     */
+    void attachToParameter(juce::RangedAudioParameter& parameter);
+
+    /** Moves the knob to the parameter's current value. Repaints only if that changed. */
+    void syncToParameter();
+
 private:
     KnobIndicatorLookAndFeel mLookAndFeel;
+    juce::RangedAudioParameter* mParameter = nullptr;
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(KnobIndicator)
 };
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "MeterDisplay.hpp"
+
+namespace {
+    const juce::Colour kTrackColour {0x40000000};
+    const juce::Colour kLevelColour {0xffb8b8b8};
+    const juce::Colour kReductionColour {0xffd98c3a};
+    const juce::Colour kSpectrumColour {0xffb8b8b8};
+
+    float fallTowards(float target, float current, double elapsedSeconds, float dbPerSecond) {
+        return juce::jmax(target, current - static_cast<float>(dbPerSecond * elapsedSeconds));
+    }
+}  // namespace
+
+LevelMeter::LevelMeter(Style style) : mStyle(style) {
+    // Reduction starts at 0 dB and the bars only ever cover part of the background
+    if (mStyle == Style::reduction) mPeakDb = 0.0f;
+    setOpaque(false);
+    setInterceptsMouseClicks(false, false);
+}
+
+void LevelMeter::update(float peakDb, float rmsDb, double elapsedSeconds) {
+    mPeakDb = fallTowards(peakDb, mPeakDb, elapsedSeconds, kFallDbPerSecond);
+    mRmsDb  = fallTowards(rmsDb, mRmsDb, elapsedSeconds, kFallDbPerSecond);
+
+    mHoldSeconds += elapsedSeconds;
+    if (mPeakDb >= mHoldDb || mHoldSeconds > kPeakHoldSeconds) {
+        mHoldDb      = mPeakDb;
+        mHoldSeconds = 0.0;
+    }
+
+    const auto peakPixels = toPixels(mPeakDb);
+    const auto rmsPixels  = toPixels(mRmsDb);
+    const auto holdPixels = toPixels(mHoldDb);
+    if (peakPixels == mPeakPixels && rmsPixels == mRmsPixels && holdPixels == mHoldPixels) return;
+
+    mPeakPixels = peakPixels;
+    mRmsPixels  = rmsPixels;
+    mHoldPixels = holdPixels;
+    repaint();
+}
+
+void LevelMeter::paint(juce::Graphics& g) {
+    const auto bounds = getLocalBounds();
+    g.setColour(kTrackColour);
+    g.fillRect(bounds);
+
+    if (mStyle == Style::reduction) {
+        g.setColour(kReductionColour);
+        g.fillRect(bounds.withHeight(mPeakPixels));
+        return;
+    }
+
+    g.setColour(kLevelColour.withAlpha(0.4f));
+    g.fillRect(bounds.withTop(bounds.getBottom() - mPeakPixels));
+    g.setColour(kLevelColour);
+    g.fillRect(bounds.withTop(bounds.getBottom() - mRmsPixels));
+
+    if (mHoldPixels > 0) g.fillRect(bounds.withTop(bounds.getBottom() - mHoldPixels).withHeight(1));
+}
+
+int LevelMeter::toPixels(float db) const {
+    const auto proportion = mStyle == Style::reduction ? db / kMaxReductionDb
+                                                       : (db - kMinLevelDb) / (kMaxLevelDb - kMinLevelDb);
+    return juce::roundToInt(juce::jlimit(0.0f, 1.0f, proportion) * static_cast<float>(getHeight()));
+}
+
+void SpectrumDisplay::prepare(double sampleRate) {
+    mSampleRate = sampleRate;
+    mAnalyzer.prepare(sampleRate);
+    repaint();
+}
+
+void SpectrumDisplay::update(const float* samples, int numSamples, double elapsedSeconds) {
+    mAnalyzer.push(samples, numSamples);
+    if (mAnalyzer.update(elapsedSeconds)) repaint();
+}
+
+void SpectrumDisplay::paint(juce::Graphics& g) {
+    const auto bounds = getLocalBounds().toFloat();
+    g.setColour(kTrackColour);
+    g.fillRect(bounds);
+
+    const auto toY = [&](float db) {
+        return juce::jmap(juce::jlimit(kMinDb, kMaxDb, db), kMinDb, kMaxDb, bounds.getBottom(), bounds.getY());
+    };
+
+    mPath.clear();
+    mPath.startNewSubPath(bounds.getBottomLeft());
+
+    for (int point = 0; point < SpectrumAnalyzer::kNumPoints; ++point) {
+        const auto x = bounds.getX() + SpectrumAnalyzer::getPosition(point) * bounds.getWidth();
+        mPath.lineTo(x, toY(mAnalyzer.getLevelDb(point)));
+    }
+
+    mPath.lineTo(bounds.getBottomRight());
+    mPath.closeSubPath();
+
+    g.setColour(kSpectrumColour.withAlpha(0.3f));
+    g.fillPath(mPath);
+    g.setColour(kSpectrumColour);
+    g.strokePath(mPath, juce::PathStrokeType(1.0f));
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include "SpectrumAnalyzer.hpp"
+
+/**
+ * A vertical bar meter. The level style shows RMS as the bar, the peak as a lighter bar above it and a held peak
+ * line, rising from the bottom. The reduction style hangs a single bar from the top. Both fall back at
+ * kFallDbPerSecond and repaint only when something moves by at least a pixel.
+ */
+class LevelMeter : public juce::Component {
+public:
+    enum class Style { level, reduction };
+
+    static constexpr float kMinLevelDb       = -60.0f;
+    static constexpr float kMaxLevelDb       = 6.0f;
+    static constexpr float kMaxReductionDb   = 24.0f;
+    static constexpr float kFallDbPerSecond  = 24.0f;
+    static constexpr double kPeakHoldSeconds = 1.5;
+
+    explicit LevelMeter(Style style);
+
+    /** Takes the loudest levels since the last call, in dB. The reduction style only uses peakDb. */
+    void update(float peakDb, float rmsDb, double elapsedSeconds);
+
+    void paint(juce::Graphics& g) override;
+
+private:
+    Style mStyle;
+
+    float mPeakDb       = kMinLevelDb;
+    float mRmsDb        = kMinLevelDb;
+    float mHoldDb       = kMinLevelDb;
+    double mHoldSeconds = 0.0;
+
+    // Bar lengths and the hold line's position as last painted
+    int mPeakPixels = 0;
+    int mRmsPixels  = 0;
+    int mHoldPixels = 0;
+
+    int toPixels(float db) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LevelMeter)
+};
+
+/**
+ * Draws a SpectrumAnalyzer's points as a filled curve, 20 Hz to 20 kHz on a log axis, kMinDb to kMaxDb. update()
+ * feeds it from the message thread and repaints only if the spectrum changed.
+ */
+class SpectrumDisplay : public juce::Component {
+public:
+    static constexpr float kMinDb = -84.0f;
+    static constexpr float kMaxDb = 6.0f;
+
+    void prepare(double sampleRate);
+    void update(const float* samples, int numSamples, double elapsedSeconds);
+
+    double getSampleRate() const {
+        return mSampleRate;
+    }
+
+    void paint(juce::Graphics& g) override;
+
+private:
+    SpectrumAnalyzer mAnalyzer;
+    double mSampleRate = 0.0;
+    juce::Path mPath;  // Reused, so a repaint doesn't allocate once it has grown
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumDisplay)
+};
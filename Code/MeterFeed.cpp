@@ -0,0 +1,158 @@
+#include "MeterFeed.hpp"
+
+#include <juce_dsp/juce_dsp.h>
+
+namespace {
+    // Below this either level is treated as silence, which reduces nothing
+    constexpr float kMinLevel = 1.0e-5f;
+
+    template<typename SampleType>
+    SampleType sumOfSquares(const SampleType* data, int numSamples) {
+        int i          = 0;
+        SampleType sum = 0;
+
+#if JUCE_USE_SIMD
+        using Vector             = juce::dsp::SIMDRegister<SampleType>;
+        constexpr auto laneCount = static_cast<int>(Vector::SIMDNumElements);
+
+        // The host's buffers carry no alignment guarantee, so bounce through the stack
+        alignas(sizeof(Vector)) SampleType aligned[Vector::SIMDNumElements];
+        auto accumulator = Vector::expand(0);
+
+        for (; i + laneCount <= numSamples; i += laneCount) {
+            std::memcpy(aligned, data + i, sizeof(aligned));
+            const auto lanes = Vector::fromRawArray(aligned);
+            accumulator      = accumulator + lanes * lanes;
+        }
+
+        sum = accumulator.sum();
+#endif
+
+        for (; i < numSamples; ++i) {
+            sum += data[i] * data[i];
+        }
+
+        return sum;
+    }
+}  // namespace
+
+float MeterFeed::Summary::getGainReductionDb() const {
+    if (inputPeak < kMinLevel || outputPeak < kMinLevel) return 0.0f;
+
+    const auto linearPeakDb = juce::Decibels::gainToDecibels(inputPeak) + linearGainDb;
+    return juce::jmax(0.0f, linearPeakDb - juce::Decibels::gainToDecibels(outputPeak));
+}
+
+void MeterFeed::prepare(double sampleRate, int maximumBlockSize) {
+    mDecimationFactor = juce::jmax(1, static_cast<int>(std::ceil(sampleRate / kMaxAnalysisRate - 1.0e-6)));
+    mDecimationCount  = 0;
+    mDecimationSum    = 0.0f;
+    mAnalysisRate     = sampleRate / mDecimationFactor;
+    mDecimated.assign(static_cast<size_t>(maximumBlockSize / mDecimationFactor + 1), 0.0f);
+}
+
+template<typename SampleType>
+void MeterFeed::beginBlock(const juce::AudioBuffer<SampleType>& input) {
+    mBlockActive = mActive.load(std::memory_order_relaxed);
+    if (mBlockActive) mInputLevels = measure(input);
+}
+
+template<typename SampleType>
+void MeterFeed::endBlock(const juce::AudioBuffer<SampleType>& output, float linearGainDb) {
+    if (!mBlockActive) return;
+    mBlockActive = false;
+
+    const auto outputLevels = measure(output);
+
+    Summary summary;
+    summary.inputPeak    = mInputLevels.peak;
+    summary.inputRms     = mInputLevels.rms;
+    summary.outputPeak   = outputLevels.peak;
+    summary.outputRms    = outputLevels.rms;
+    summary.linearGainDb = linearGainDb;
+
+    const auto scope = mSummaryFifo.write(1);
+    if (scope.blockSize1 > 0) mSummaries[static_cast<size_t>(scope.startIndex1)] = summary;
+
+    if (mAnalyzerEnabled.load(std::memory_order_relaxed)) pushAnalyzerSamples(output);
+}
+
+template<typename SampleType>
+MeterFeed::Levels MeterFeed::measure(const juce::AudioBuffer<SampleType>& buffer) {
+    const auto numChannels = buffer.getNumChannels();
+    const auto numSamples  = buffer.getNumSamples();
+    if (numChannels == 0 || numSamples == 0) return {};
+
+    SampleType peak = 0;
+    SampleType sum  = 0;
+
+    for (int channel = 0; channel < numChannels; ++channel) {
+        const auto* data = buffer.getReadPointer(channel);
+        const auto range = juce::FloatVectorOperations::findMinAndMax(data, numSamples);
+
+        peak = juce::jmax(peak, -range.getStart(), range.getEnd());
+        sum += sumOfSquares(data, numSamples);
+    }
+
+    // RMS over every channel together, the same energy a single bar can show for any layout
+    const auto meanSquare = sum / static_cast<SampleType>(numChannels * numSamples);
+    return {static_cast<float>(peak), static_cast<float>(std::sqrt(meanSquare))};
+}
+
+template<typename SampleType>
+void MeterFeed::pushAnalyzerSamples(const juce::AudioBuffer<SampleType>& output) {
+    const auto numChannels = output.getNumChannels();
+    const auto numSamples  = output.getNumSamples();
+    if (numChannels == 0) return;
+
+    // Mono sum, averaged over mDecimationFactor samples. A box filter is a crude anti-aliasing filter, but it only
+    // runs above kMaxAnalysisRate where the analyzer's display range ends well below the folding frequency.
+    const auto scale         = 1.0f / static_cast<float>(numChannels * mDecimationFactor);
+    const auto maxDecimated  = static_cast<int>(mDecimated.size());
+    const auto* const* input = output.getArrayOfReadPointers();
+    int numDecimated         = 0;
+
+    for (int i = 0; i < numSamples; ++i) {
+        SampleType frame = 0;
+        for (int channel = 0; channel < numChannels; ++channel) frame += input[channel][i];
+
+        mDecimationSum += static_cast<float>(frame);
+        if (++mDecimationCount < mDecimationFactor) continue;
+
+        if (numDecimated < maxDecimated) mDecimated[static_cast<size_t>(numDecimated++)] = mDecimationSum * scale;
+        mDecimationSum   = 0.0f;
+        mDecimationCount = 0;
+    }
+
+    // All or nothing, so the analyzer never sees a gap inside a block
+    if (mSampleFifo.getFreeSpace() < numDecimated) return;
+
+    const auto scope = mSampleFifo.write(numDecimated);
+    std::copy_n(mDecimated.data(), scope.blockSize1, mSamples.data() + scope.startIndex1);
+    std::copy_n(mDecimated.data() + scope.blockSize1, scope.blockSize2, mSamples.data() + scope.startIndex2);
+}
+
+int MeterFeed::readSummaries(Summary* destination, int maxSummaries) {
+    const auto scope = mSummaryFifo.read(maxSummaries);
+    int numRead      = 0;
+
+    scope.forEach([&](int index) { destination[numRead++] = mSummaries[static_cast<size_t>(index)]; });
+    return numRead;
+}
+
+int MeterFeed::readSamples(float* destination, int maxSamples) {
+    const auto scope = mSampleFifo.read(maxSamples);
+    std::copy_n(mSamples.data() + scope.startIndex1, scope.blockSize1, destination);
+    std::copy_n(mSamples.data() + scope.startIndex2, scope.blockSize2, destination + scope.blockSize1);
+    return scope.blockSize1 + scope.blockSize2;
+}
+
+void MeterFeed::discardPending() {
+    mSummaryFifo.finishedRead(mSummaryFifo.getNumReady());
+    mSampleFifo.finishedRead(mSampleFifo.getNumReady());
+}
+
+template void MeterFeed::beginBlock(const juce::AudioBuffer<float>&);
+template void MeterFeed::beginBlock(const juce::AudioBuffer<double>&);
+template void MeterFeed::endBlock(const juce::AudioBuffer<float>&, float);
+template void MeterFeed::endBlock(const juce::AudioBuffer<double>&, float);
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+/**
+ * Level summaries and analyzer samples handed from the audio thread to the editor, without locks or allocation.
+ *
+ * processBlock() brackets the engine with beginBlock()/endBlock(). Each block becomes one Summary (peak and RMS over
+ * all channels, computed with SIMD) pushed into a wait-free SPSC ring. While the analyzer is enabled the output is
+ * also summed to mono, decimated to at most kMaxAnalysisRate by averaging and pushed into a second ring. Nothing at
+ * all is measured while the feed is inactive, i.e. while no editor is open. Both rings drop data when full, so a
+ * stalled consumer never holds up the audio thread. Exactly one consumer (the editor's MeterPanel) reads them.
+ */
+class MeterFeed {
+public:
+    static constexpr int kSummaryRingSize    = 1024;
+    static constexpr int kSampleRingSize     = 32768;
+    static constexpr double kMaxAnalysisRate = 48000.0;
+
+    struct Summary {
+        float inputPeak  = 0.0f;
+        float inputRms   = 0.0f;
+        float outputPeak = 0.0f;
+        float outputRms  = 0.0f;
+
+        // The gain a linear stage with the curve's small-signal slope and the output gain would have applied, dB
+        float linearGainDb = 0.0f;
+
+        /**
+         * How far the output peak sits below that linear stage, in dB. 0 while the curve is still straight, growing
+         * as drive pushes the signal into saturation.
+         */
+        float getGainReductionDb() const;
+    };
+
+    /** Sizes the decimator. Not realtime safe. */
+    void prepare(double sampleRate, int maximumBlockSize);
+
+    /** Can be called from any thread. Takes effect at the start of the next block. */
+    void setActive(bool active) {
+        mActive = active;
+    }
+
+    void setAnalyzerEnabled(bool enabled) {
+        mAnalyzerEnabled = enabled;
+    }
+
+    /** The rate of the samples readSamples() returns. */
+    double getAnalysisRate() const {
+        return mAnalysisRate.load(std::memory_order_relaxed);
+    }
+
+    // Audio thread
+
+    /** Measures the block before processing. Both calls take float or double buffers. */
+    template<typename SampleType>
+    void beginBlock(const juce::AudioBuffer<SampleType>& input);
+
+    template<typename SampleType>
+    void endBlock(const juce::AudioBuffer<SampleType>& output, float linearGainDb);
+
+    // Consumer
+
+    /** Copies up to maxSummaries of the oldest queued summaries into destination. Single consumer only. */
+    int readSummaries(Summary* destination, int maxSummaries);
+
+    /** Copies up to maxSamples of the oldest queued analyzer samples into destination. Single consumer only. */
+    int readSamples(float* destination, int maxSamples);
+
+    /** Drops everything queued, e.g. what piled up while no editor was reading. Single consumer only. */
+    void discardPending();
+
+private:
+    struct Levels {
+        float peak = 0.0f;
+        float rms  = 0.0f;
+    };
+
+    template<typename SampleType>
+    static Levels measure(const juce::AudioBuffer<SampleType>& buffer);
+
+    template<typename SampleType>
+    void pushAnalyzerSamples(const juce::AudioBuffer<SampleType>& output);
+
+    std::atomic<bool> mActive {false};
+    std::atomic<bool> mAnalyzerEnabled {false};
+    std::atomic<double> mAnalysisRate {44100.0};
+
+    // Audio thread only
+    bool mBlockActive = false;
+    Levels mInputLevels;
+    int mDecimationFactor = 1;
+    int mDecimationCount  = 0;
+    float mDecimationSum  = 0.0f;
+    std::vector<float> mDecimated;  // One block's worth of analyzer samples, sized in prepare()
+
+    juce::AbstractFifo mSummaryFifo {kSummaryRingSize};
+    std::array<Summary, kSummaryRingSize> mSummaries;
+
+    juce::AbstractFifo mSampleFifo {kSampleRingSize};
+    std::vector<float> mSamples = std::vector<float>(kSampleRingSize);
+};
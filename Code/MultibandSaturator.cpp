@@ -0,0 +1,340 @@
+#include "MultibandSaturator.hpp"
+
+namespace {
+    template<typename SampleType>
+    juce::dsp::AudioBlock<SampleType>
+    getBandBlock(juce::AudioBuffer<SampleType>& buffer, size_t numChannels, int numSamples) {
+        return juce::dsp::AudioBlock<SampleType>(buffer)
+          .getSubsetChannelBlock(0, numChannels)
+          .getSubBlock(0, static_cast<size_t>(numSamples));
+    }
+
+    // Converts a curve in decibels to linear gain in place. The drive curves are sums of linear ramps, clamped, so a
+    // run is nearly always a straight line in dB, which is a geometric series in gain: an exact pow for its first
+    // sample and one for the ratio, like BlockSmoother::renderDecibelsToGain(). Only a run with a kink in it (a ramp
+    // ending or reaching the clamp) is converted sample by sample.
+    template<typename SampleType>
+    void decibelsToGain(SampleType* curve, int numSamples) {
+        constexpr int runLength    = 64;
+        constexpr double tolerance = 1e-3;  // dB, well above the float rounding of the summed ramps
+
+        for (int start = 0; start < numSamples; start += runLength) {
+            auto* run       = curve + start;
+            const auto last = juce::jmin(runLength, numSamples - start) - 1;
+
+            // A single kink makes the first or the last step differ from the average one
+            const auto step     = last > 0 ? (static_cast<double>(run[last]) - run[0]) / last : 0.0;
+            const auto drift    = [&](int i) {
+                return std::abs(static_cast<double>(run[i + 1]) - static_cast<double>(run[i]) - step) * last;
+            };
+            const bool isLinear = last < 2 || (drift(0) <= tolerance && drift(last - 1) <= tolerance);
+
+            if (!isLinear) {
+                for (int i = 0; i <= last; ++i) {
+                    run[i] = juce::Decibels::decibelsToGain(run[i]);
+                }
+                continue;
+            }
+
+            const auto ratio = std::pow(10.0, step * 0.05);
+            auto gain        = juce::Decibels::decibelsToGain(static_cast<double>(run[0]));
+            for (int i = 0; i <= last; ++i) {
+                run[i] = static_cast<SampleType>(gain);
+                gain *= ratio;
+            }
+        }
+    }
+}  // namespace
+
+template<typename SampleType>
+void MultibandSaturator<SampleType>::prepare(double sampleRate, int numChannels, int maximumBlockSize) {
+    mSampleRate = sampleRate;
+
+    juce::dsp::ProcessSpec spec {};
+    spec.sampleRate       = sampleRate;
+    spec.maximumBlockSize = static_cast<juce::uint32>(maximumBlockSize);
+    spec.numChannels      = static_cast<juce::uint32>(numChannels);
+
+    for (auto& crossover : mSplits) {
+        crossover.prepare(spec);
+    }
+    for (auto& allpass : mAllpasses) {
+        allpass.setType(juce::dsp::LinkwitzRileyFilterType::allpass);
+        allpass.prepare(spec);
+    }
+
+    // Every band can be asked for any order, so each gets the full bank. Bands use the realtime filters in both
+    // processing modes.
+    for (size_t band = 0; band < kMaxBands; ++band) {
+        mOversampling[band].prepare(numChannels, maximumBlockSize, false);
+        mBands[band].setSize(numChannels, maximumBlockSize, false, true, false);
+        mDryBands[band].setSize(numChannels, maximumBlockSize, false, true, false);
+
+        const auto maxLatency = juce::jmax(1, mOversampling[band].getMaxLatencyInSamples());
+        mDryDelays[band].setMaximumDelayInSamples(maxLatency);
+        mDryDelays[band].prepare(spec);
+        mAlignDelays[band].setMaximumDelayInSamples(maxLatency);
+        mAlignDelays[band].prepare(spec);
+
+        mDriveOffsets[band].reset(sampleRate, kSmoothingTimeSeconds);
+        mDriveOffsets[band].setCurrentAndTargetValue(mSettings.driveOffsets[band]);
+        mMixes[band].reset(sampleRate, kSmoothingTimeSeconds);
+        mMixes[band].setCurrentAndTargetValue(mSettings.mixes[band]);
+
+        mBandDrives[band].assign(static_cast<size_t>(maximumBlockSize) << OversamplerBankBase::kMaxOrder, 1.0f);
+        mBandMixes[band].assign(static_cast<size_t>(maximumBlockSize), 1.0f);
+    }
+}
+
+template<typename SampleType>
+void MultibandSaturator<SampleType>::reset() {
+    for (auto& crossover : mSplits) {
+        crossover.reset();
+    }
+    for (auto& allpass : mAllpasses) {
+        allpass.reset();
+    }
+
+    for (size_t band = 0; band < kMaxBands; ++band) {
+        mOversampling[band].reset();
+        mDryDelays[band].reset();
+        mAlignDelays[band].reset();
+        mDriveOffsets[band].setCurrentAndTargetValue(mDriveOffsets[band].getTargetValue());
+        mMixes[band].setCurrentAndTargetValue(mMixes[band].getTargetValue());
+    }
+}
+
+template<typename SampleType>
+bool MultibandSaturator<SampleType>::configure(const Settings& settings, int maxOrder, FilterType filterType) {
+    mSettings          = settings;
+    mSettings.numBands = juce::jlimit(1, kMaxBands, settings.numBands);
+
+    // Keep the crossovers in order and clear of Nyquist
+    const auto numCrossovers = mSettings.numBands - 1;
+    const auto maxFrequency  = static_cast<float>(mSampleRate * 0.45);
+    for (auto& frequency : mSettings.crossovers) {
+        frequency = juce::jlimit(20.0f, maxFrequency, frequency);
+    }
+    std::sort(mSettings.crossovers.begin(), mSettings.crossovers.begin() + juce::jmax(0, numCrossovers));
+
+    const auto& crossovers = mSettings.crossovers;
+    for (size_t i = 0; i < kMaxCrossovers; ++i) {
+        mSplits[i].setCutoffFrequency(static_cast<SampleType>(crossovers[i]));
+    }
+
+    if (mSettings.numBands == 3) {
+        mAllpasses[0].setCutoffFrequency(static_cast<SampleType>(crossovers[1]));
+    } else if (mSettings.numBands == 4) {
+        mAllpasses[0].setCutoffFrequency(static_cast<SampleType>(crossovers[2]));
+        mAllpasses[1].setCutoffFrequency(static_cast<SampleType>(crossovers[0]));
+    }
+
+    for (size_t band = 0; band < kMaxBands; ++band) {
+        mDriveOffsets[band].setTargetValue(mSettings.driveOffsets[band]);
+        mMixes[band].setTargetValue(mSettings.mixes[band]);
+    }
+
+    // Each band at the order it needs, then everything delayed up to the slowest band
+    const auto previousLatency = mLatency;
+    mLatency                   = 0;
+
+    for (int band = 0; band < mSettings.numBands; ++band) {
+        const auto index   = static_cast<size_t>(band);
+        auto& oversampling = mOversampling[index];
+
+        // A new order changes the band's latency, so whatever its delays hold is misaligned with the new filters
+        if (oversampling.select(getRequiredOrder(band, maxOrder), filterType)) {
+            mDryDelays[index].reset();
+            mAlignDelays[index].reset();
+        }
+        mLatency = juce::jmax(mLatency, oversampling.getLatencyInSamples());
+    }
+
+    for (size_t band = 0; band < kMaxBands; ++band) {
+        const auto latency = mOversampling[band].getLatencyInSamples();
+        mDryDelays[band].setDelay(static_cast<SampleType>(latency));
+        mAlignDelays[band].setDelay(static_cast<SampleType>(juce::jmax(0, mLatency - latency)));
+    }
+
+    return mLatency != previousLatency;
+}
+
+template<typename SampleType>
+int MultibandSaturator<SampleType>::getMaxLatencyInSamples() const {
+    int maxLatency = 0;
+    for (const auto& oversampling : mOversampling) {
+        maxLatency = juce::jmax(maxLatency, oversampling.getMaxLatencyInSamples());
+    }
+    return maxLatency;
+}
+
+template<typename SampleType>
+int MultibandSaturator<SampleType>::getTailInSamples() const {
+    const auto lowestCrossover = static_cast<double>(mSettings.crossovers[0]);
+    return 2 * mLatency + juce::roundToInt(kCrossoverDecayPeriods / lowestCrossover * mSampleRate);
+}
+
+template<typename SampleType>
+int MultibandSaturator<SampleType>::getRequiredOrder(int band, int maxOrder) const {
+    if (band == mSettings.numBands - 1) return maxOrder;
+
+    // An octave above the crossover the LR4 slope is 24 dB down, that's where the band's content is taken to end
+    const auto edge  = 2.0 * mSettings.crossovers[static_cast<size_t>(band)];
+    const auto ratio = 2.0 * kAliasFreeHarmonics * edge / mSampleRate;
+    const auto order = ratio <= 1.0 ? 0 : static_cast<int>(std::ceil(std::log2(ratio)));
+    return juce::jlimit(0, maxOrder, order);
+}
+
+template<typename SampleType>
+void MultibandSaturator<SampleType>::process(Block& block,
+                                             const SampleType* driveDb,
+                                             float settledDriveDb,
+                                             SaturationKernel::Mode mode) {
+    const auto numSamples  = static_cast<int>(block.getNumSamples());
+    const auto numChannels = block.getNumChannels();
+    const auto numBands    = mSettings.numBands;
+    jassert(numBands > 1);  // A single band is the engine's full band path
+    if (numSamples == 0) return;
+
+    split(block);
+
+    for (int band = 0; band < numBands; ++band) {
+        const auto index = static_cast<size_t>(band);
+        auto wet         = getBandBlock(mBands[index], numChannels, numSamples);
+        auto dry         = getBandBlock(mDryBands[index], numChannels, numSamples);
+
+        const bool driveMoving = renderControls(band, driveDb, settledDriveDb, numSamples);
+        shapeBand(band, wet, driveMoving, mode);
+
+        const auto latency = mOversampling[index].getLatencyInSamples();
+        if (latency > 0) mDryDelays[index].process(juce::dsp::ProcessContextReplacing<SampleType>(dry));
+
+        const auto* mix = mBandMixes[index].data();
+        for (size_t channel = 0; channel < numChannels; ++channel) {
+            auto* wetData       = wet.getChannelPointer(channel);
+            const auto* dryData = dry.getChannelPointer(channel);
+
+            for (int i = 0; i < numSamples; ++i) {
+                wetData[i] = dryData[i] + mix[i] * (wetData[i] - dryData[i]);
+            }
+        }
+
+        if (latency < mLatency) mAlignDelays[index].process(juce::dsp::ProcessContextReplacing<SampleType>(wet));
+
+        if (band == 0) block.copyFrom(wet);
+        else block.add(wet);
+    }
+}
+
+template<typename SampleType>
+void MultibandSaturator<SampleType>::split(const Block& block) {
+    const auto numSamples = block.getNumSamples();
+
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel) {
+        const auto* input = block.getChannelPointer(channel);
+        const auto index  = static_cast<int>(channel);
+
+        std::array<SampleType*, kMaxBands> bands {};
+        for (size_t band = 0; band < kMaxBands; ++band) {
+            bands[band] = mBands[band].getWritePointer(index);
+        }
+
+        switch (mSettings.numBands) {
+            case 3:
+                for (size_t i = 0; i < numSamples; ++i) {
+                    SampleType upper;
+                    mSplits[0].processSample(index, input[i], bands[0][i], upper);
+                    mSplits[1].processSample(index, upper, bands[1][i], bands[2][i]);
+                    bands[0][i] = mAllpasses[0].processSample(index, bands[0][i]);
+                }
+                break;
+
+            default:
+                for (size_t i = 0; i < numSamples; ++i) {
+                    SampleType lower, upper;
+                    mSplits[1].processSample(index, input[i], lower, upper);
+                    lower = mAllpasses[0].processSample(index, lower);
+                    upper = mAllpasses[1].processSample(index, upper);
+                    mSplits[0].processSample(index, lower, bands[0][i], bands[1][i]);
+                    mSplits[2].processSample(index, upper, bands[2][i], bands[3][i]);
+                }
+                break;
+        }
+
+        // Each band's dry signal, for its own mix
+        for (int band = 0; band < mSettings.numBands; ++band) {
+            const auto bandIndex = static_cast<size_t>(band);
+            mDryBands[bandIndex].copyFrom(index, 0, mBands[bandIndex], index, 0, static_cast<int>(numSamples));
+        }
+    }
+}
+
+template<typename SampleType>
+bool MultibandSaturator<SampleType>::renderControls(int band,
+                                                    const SampleType* driveDb,
+                                                    float settledDriveDb,
+                                                    int numSamples) {
+    const auto index   = static_cast<size_t>(band);
+    auto* drive        = mBandDrives[index].data();
+    auto* mix          = mBandMixes[index].data();
+    auto& driveOffset  = mDriveOffsets[index];
+    auto& mixSmoothed  = mMixes[index];
+    const auto clampDb = [](auto value) { return juce::jlimit(0.0f, kMaxDriveDb, static_cast<float>(value)); };
+
+    // Both settled is the common case and costs a single pow, otherwise the sum is converted as a curve
+    const bool driveMoving = driveDb != nullptr || driveOffset.isSmoothing();
+    if (!driveMoving) {
+        const auto gain = juce::Decibels::decibelsToGain(clampDb(settledDriveDb + driveOffset.getTargetValue()));
+        drive[0]        = static_cast<SampleType>(gain);
+    } else {
+        if (driveOffset.isSmoothing()) driveOffset.render(drive, numSamples);
+        else std::fill(drive, drive + numSamples, static_cast<SampleType>(driveOffset.getTargetValue()));
+
+        for (int i = 0; i < numSamples; ++i) {
+            const auto mainDb = driveDb != nullptr ? driveDb[i] : static_cast<SampleType>(settledDriveDb);
+            drive[i]          = static_cast<SampleType>(clampDb(mainDb + drive[i]));
+        }
+        decibelsToGain(drive, numSamples);
+    }
+
+    if (mixSmoothed.isSmoothing()) {
+        mixSmoothed.render(mix, numSamples);
+        juce::FloatVectorOperations::multiply(mix, SampleType(0.01), numSamples);
+    } else {
+        std::fill(mix, mix + numSamples, static_cast<SampleType>(mixSmoothed.getTargetValue() * 0.01f));
+    }
+
+    return driveMoving;
+}
+
+template<typename SampleType>
+void MultibandSaturator<SampleType>::shapeBand(int band,
+                                               Block& block,
+                                               bool driveMoving,
+                                               SaturationKernel::Mode mode) {
+    const auto index       = static_cast<size_t>(band);
+    auto& oversampler      = mOversampling[index].getCurrent();
+    const auto oversampled = oversampler.processSamplesUp(block);
+    const auto order       = getBandOrder(band);
+    const auto numSamples  = static_cast<int>(oversampled.getNumSamples());
+    auto* drive            = mBandDrives[index].data();
+
+    // Hold each base rate drive across the oversampled samples it covers, back to front so it can be done in place
+    if (driveMoving && order > 0) {
+        for (int i = numSamples - 1; i >= 0; --i) {
+            drive[i] = drive[i >> order];
+        }
+    }
+
+    // Each channel of the band is one contiguous run, which the kernel vectorises on its own
+    for (size_t channel = 0; channel < oversampled.getNumChannels(); ++channel) {
+        auto* data = oversampled.getChannelPointer(channel);
+        if (driveMoving) SaturationKernel::process(data, drive, numSamples, mode);
+        else SaturationKernel::process(data, drive[0], numSamples, mode);
+    }
+
+    oversampler.processSamplesDown(block);
+}
+
+template class MultibandSaturator<float>;
+template class MultibandSaturator<double>;
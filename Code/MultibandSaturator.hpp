@@ -0,0 +1,121 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include "BlockSmoother.hpp"
+#include "OversamplerBank.hpp"
+#include "SaturationKernel.hpp"
+
+/** The band settings shared by both sample types of MultibandSaturator. */
+class MultibandSaturatorBase {
+public:
+    static constexpr int kMaxBands      = 4;
+    static constexpr int kMaxCrossovers = kMaxBands - 1;
+
+    /**
+     * CPU budget of the mode, in ns per band, channel and base rate sample, with every band moving its drive. A band
+     * costs about what the full band path costs at that band's oversampling factor, so this leaves room for the top
+     * band at 16x. GregBench --bands reports against it.
+     */
+    static constexpr double kBudgetNsPerBandSample = 25.0;
+
+    struct Settings {
+        int numBands = 1;  // 1 leaves the signal to the full band path, 3 or 4 split it
+
+        // Hz, ascending, the first numBands - 1 are used
+        std::array<float, kMaxCrossovers> crossovers {120.0f, 800.0f, 5000.0f};
+
+        std::array<float, kMaxBands> driveOffsets {};                         // dB, added to the main drive
+        std::array<float, kMaxBands> mixes {100.0f, 100.0f, 100.0f, 100.0f};  // %, within each band
+
+        bool operator==(const Settings&) const = default;
+    };
+};
+
+/**
+ * Greg's curve in 3 or 4 bands, each with its own drive offset and mix.
+ *
+ * A Linkwitz-Riley (LR4) crossover tree splits the signal at the base rate. The branches that skip a split run
+ * through that split's allpass, so the bands sum back to an allpass of the input when left dry. Every band is only
+ * oversampled as much as its upper edge needs (kAliasFreeHarmonics harmonics of the frequency an octave above it
+ * stay below the oversampled Nyquist), capped at the order the engine selected, so a low band under 200 Hz runs at
+ * 1x while the top band gets the full factor. Each band is then shaped on its own contiguous buffer.
+ *
+ * Each band's dry signal is delayed by that band's oversampling latency for its mix, then every band is delayed up
+ * to the slowest one so they line up when summed. All allocation happens in prepare(). Instantiated for float and
+ * double.
+ */
+template<typename SampleType>
+class MultibandSaturator : public MultibandSaturatorBase {
+public:
+    using Block      = juce::dsp::AudioBlock<SampleType>;
+    using FilterType = OversamplerBankBase::FilterType;
+
+    void prepare(double sampleRate, int numChannels, int maximumBlockSize);
+    void reset();
+
+    /**
+     * Applies the band count and crossovers and picks each band's oversampling order, at most maxOrder. Band drive
+     * offsets and mixes ramp to their new values. Returns true if the latency changed.
+     */
+    bool configure(const Settings& settings, int maxOrder, FilterType filterType);
+
+    int getLatencyInSamples() const {
+        return mLatency;
+    }
+
+    /** The largest latency any configuration can have, for sizing the engine's dry delay. */
+    int getMaxLatencyInSamples() const;
+
+    /** Latency plus the time the oversampling filters and the lowest crossover need to ring out. */
+    int getTailInSamples() const;
+
+    int getBandOrder(int band) const {
+        return mOversampling[static_cast<size_t>(band)].getOrder();
+    }
+
+    /**
+     * Splits, shapes and sums the block in place. driveDb holds the main drive in decibels for every sample, or is
+     * null while it sits at settledDriveDb.
+     */
+    void process(Block& block, const SampleType* driveDb, float settledDriveDb, SaturationKernel::Mode mode);
+
+private:
+    static constexpr int kAliasFreeHarmonics      = 4;
+    static constexpr float kMaxDriveDb            = 30.0f;  // The drive parameter's range, offsets can't exceed it
+    static constexpr double kSmoothingTimeSeconds = 0.01;
+    // An LR4 section decays by 120 dB in about this many periods of its cutoff
+    static constexpr double kCrossoverDecayPeriods = 3.1;
+
+    using Crossover = juce::dsp::LinkwitzRileyFilter<SampleType>;
+    using Delay     = juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::None>;
+
+    double mSampleRate = 44100;
+    Settings mSettings;
+    int mLatency = 0;
+
+    // 3 bands: split 0, then split 1 on the upper branch, allpass 0 (at crossover 1) on band 0.
+    // 4 bands: split 1, allpass 0 (at crossover 2) on the lower branch and allpass 1 (at crossover 0) on the upper,
+    // then split 0 and split 2.
+    std::array<Crossover, kMaxCrossovers> mSplits;
+    std::array<Crossover, 2> mAllpasses;
+
+    std::array<OversamplerBank<SampleType>, kMaxBands> mOversampling;
+    std::array<juce::AudioBuffer<SampleType>, kMaxBands> mBands;
+    std::array<juce::AudioBuffer<SampleType>, kMaxBands> mDryBands;
+    std::array<Delay, kMaxBands> mDryDelays;    // By the band's own latency
+    std::array<Delay, kMaxBands> mAlignDelays;  // The rest of the way to mLatency
+
+    std::array<BlockSmoother, kMaxBands> mDriveOffsets;
+    std::array<BlockSmoother, kMaxBands> mMixes;
+
+    // Per band drive gain, held up to the band's oversampled rate, and mix at the base rate
+    std::array<std::vector<SampleType>, kMaxBands> mBandDrives;
+    std::array<std::vector<SampleType>, kMaxBands> mBandMixes;
+
+    void split(const Block& block);
+    /** Renders the band's drive and mix. Returns false if the drive is settled, which leaves it in the first slot. */
+    bool renderControls(int band, const SampleType* driveDb, float settledDriveDb, int numSamples);
+    void shapeBand(int band, Block& block, bool driveMoving, SaturationKernel::Mode mode);
+    int getRequiredOrder(int band, int maxOrder) const;
+};
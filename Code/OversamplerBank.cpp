@@ -0,0 +1,61 @@
+#include "OversamplerBank.hpp"
+
+template<typename SampleType>
+void OversamplerBank<SampleType>::prepare(int numChannels, int maximumBlockSize, bool useMaxQualityFilters) {
+    using Oversampling = juce::dsp::Oversampling<SampleType>;
+
+    for (int order = 0; order <= kMaxOrder; ++order) {
+        for (const auto filterType : {FilterType::minimumPhase, FilterType::linearPhase}) {
+            const auto juceFilterType = filterType == FilterType::linearPhase
+                                          ? Oversampling::filterHalfBandFIREquiripple
+                                          : Oversampling::filterHalfBandPolyphaseIIR;
+
+            auto& oversampler = mOversamplers[getIndex(order, filterType)];
+            oversampler       = std::make_unique<Oversampling>(static_cast<size_t>(numChannels),
+                                                               static_cast<size_t>(order),
+                                                               juceFilterType,
+                                                               useMaxQualityFilters,
+                                                               true);
+            oversampler->initProcessing(static_cast<size_t>(maximumBlockSize));
+        }
+    }
+}
+
+template<typename SampleType>
+void OversamplerBank<SampleType>::reset() {
+    for (auto& oversampler : mOversamplers) {
+        if (oversampler != nullptr) oversampler->reset();
+    }
+}
+
+template<typename SampleType>
+bool OversamplerBank<SampleType>::select(int order, FilterType filterType) {
+    order = juce::jlimit(0, kMaxOrder, order);
+    if (order == mOrder && filterType == mFilterType) return false;
+
+    mOrder      = order;
+    mFilterType = filterType;
+
+    // The newly selected filters may hold state from the last time they were used
+    getCurrent().reset();
+    return true;
+}
+
+template<typename SampleType>
+int OversamplerBank<SampleType>::getLatencyInSamples() const {
+    return static_cast<int>(getCurrent().getLatencyInSamples());
+}
+
+template<typename SampleType>
+int OversamplerBank<SampleType>::getMaxLatencyInSamples() const {
+    int maxLatency = 0;
+    for (const auto& oversampler : mOversamplers) {
+        if (oversampler != nullptr) {
+            maxLatency = juce::jmax(maxLatency, static_cast<int>(oversampler->getLatencyInSamples()));
+        }
+    }
+    return maxLatency;
+}
+
+template class OversamplerBank<float>;
+template class OversamplerBank<double>;
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+/** The settings shared by both sample types of OversamplerBank. */
+class OversamplerBankBase {
+public:
+    enum class FilterType { minimumPhase, linearPhase };
+
+    static constexpr int kMaxOrder = 4;  // 2^4 = 16x
+};
+
+/**
+ * Every oversampling factor (1x to 16x) and filter type Greg offers, built up front.
+ *
+ * All allocation happens in prepare(), so the audio thread can switch between settings with select() without
+ * touching the heap. Each oversampler uses integer latency so the dry path can be aligned with a plain delay.
+ * Instantiated for float and double.
+ */
+template<typename SampleType>
+class OversamplerBank : public OversamplerBankBase {
+public:
+    void prepare(int numChannels, int maximumBlockSize, bool useMaxQualityFilters);
+    void reset();
+
+    /** Makes the given order/filter current. Returns true if that changed the active oversampler. */
+    bool select(int order, FilterType filterType);
+
+    juce::dsp::Oversampling<SampleType>& getCurrent() const {
+        return *mOversamplers[getIndex(mOrder, mFilterType)];
+    }
+
+    int getOrder() const {
+        return mOrder;
+    }
+
+    int getFactor() const {
+        return 1 << mOrder;
+    }
+
+    int getLatencyInSamples() const;
+    int getMaxLatencyInSamples() const;
+
+private:
+    static constexpr int kNumFilterTypes = 2;
+
+    static size_t getIndex(int order, FilterType filterType) {
+        return static_cast<size_t>(order * kNumFilterTypes + static_cast<int>(filterType));
+    }
+
+    std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, (kMaxOrder + 1) * kNumFilterTypes>
+      mOversamplers;
+
+    int mOrder             = 0;
+    FilterType mFilterType = FilterType::linearPhase;
+};
@@ -2,21 +2,77 @@
 #include "PluginEditor.hpp"
 #include "BinaryData.h"
 
+namespace {
+    GregEditor::AssetLoading gAssetLoading = GregEditor::AssetLoading::shared;
+}  // namespace
+
 GregEditor::GregEditor(GregProcessor& p)
     : AudioProcessorEditor(&p), audioProcessor(p), mDriveIndicator(40.0f), mToneIndicator(16.0f), mMixIndicator(16.0f) {
-    loadImages();
     updatePresetName();
     setupComponents();
     createAttachments();
 
     // Set the editor size
-    setSize(700, 460);
+    setSize(kWidth, kHeight);
+
+    if (gAssetLoading == AssetLoading::synchronous) {
+        loadAssetsSynchronously();
+    } else {
+        // The first editor in the process starts decoding the artwork, and has the background resampled for the main
+        // display while it's at it. Later editors find it ready.
+        auto& desktop       = juce::Desktop::getInstance();
+        auto& assets        = *EditorAssets::getInstance();
+        const auto* display = desktop.getDisplays().getPrimaryDisplay();
+        const auto scale    = (display != nullptr ? display->scale : 1.0) * desktop.getGlobalScaleFactor();
+        assets.loadAsync(juce::roundToInt(kWidth * scale), juce::roundToInt(kHeight * scale));
+        if (assets.isReady()) applyAssets();
+    }
+
+    // The background covers every pixel, so nothing behind the editor needs repainting with it
+    setOpaque(true);
+
+    // Whatever queued up while no editor was open is stale
+    auto& meterFeed = audioProcessor.getMeterFeed();
+    meterFeed.discardPending();
+    meterFeed.setActive(true);
+    startTimerHz(kFrameRateHz);
+}
+
+GregEditor::~GregEditor() {
+    auto& meterFeed = audioProcessor.getMeterFeed();
+    meterFeed.setActive(false);
+    meterFeed.setAnalyzerEnabled(false);
 }
 
-GregEditor::~GregEditor() = default;
+void GregEditor::setAssetLoading(AssetLoading loading) {
+    JUCE_ASSERT_MESSAGE_THREAD
+    gAssetLoading = loading;
+}
 
 void GregEditor::paint(juce::Graphics& g) {
-    g.drawImage(mBackgroundImage, getLocalBounds().toFloat());
+    if (mSynchronousBackground.isValid()) {
+        g.drawImage(mSynchronousBackground, getLocalBounds().toFloat());
+        return;
+    }
+
+    auto& assets = *EditorAssets::getInstance();
+    if (!assets.isReady()) {
+        g.fillAll(juce::Colour(kPlaceholderColour));
+        return;
+    }
+
+    // Resampling the artwork is the expensive part, EditorAssets does it once per size and display scale for every
+    // editor. Repaints then copy just their dirty region out of it, pixel for pixel.
+    const auto scale  = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const auto width  = juce::roundToInt(static_cast<float>(getWidth()) * scale);
+    const auto height = juce::roundToInt(static_cast<float>(getHeight()) * scale);
+    if (width <= 0 || height <= 0) return;
+
+    if (mBackground.getWidth() != width || mBackground.getHeight() != height) {
+        mBackground = assets.getScaled(EditorAssets::Image::background, width, height);
+    }
+
+    g.drawImageTransformed(mBackground, juce::AffineTransform::scale(1.0f / scale));
 }
 
 void GregEditor::resized() {
@@ -30,6 +86,12 @@ void GregEditor::resized() {
     mToneIndicator.setBounds(73, 183, 100, 100);
     mMixIndicator.setBounds(526, 183, 100, 100);
     mPreButton.setBounds(79, 298, 86, 50);
+    mTelemetryLabel.setBounds(10, 436, 680, 18);
+    mInputMeter.setBounds(16, 120, 8, 220);
+    mReductionMeter.setBounds(660, 120, 8, 220);
+    mOutputMeter.setBounds(676, 120, 8, 220);
+    mSpectrumDisplay.setBounds(180, 352, 340, 76);
+    mAnalyzerButton.setBounds(528, 408, 40, 20);
 }
 
 void GregEditor::updatePresetName() {
@@ -37,96 +99,130 @@ void GregEditor::updatePresetName() {
     mPresetLabel.setText(currentPresetName, juce::dontSendNotification);
 }
 
-void GregEditor::loadImages() {
-    mBackgroundImage  = juce::ImageCache::getFromMemory(BinaryData::bg1x_png, BinaryData::bg1x_pngSize);
-    mPowerButtonImage = juce::ImageCache::getFromMemory(BinaryData::power_btn1x_png, BinaryData::power_btn1x_pngSize);
-    mRightArrowImage =
-      juce::ImageCache::getFromMemory(BinaryData::right_arrow1x_png, BinaryData::right_arrow1x_pngSize);
-    mLeftArrowImage = juce::ImageCache::getFromMemory(BinaryData::left_arrow1x_png, BinaryData::left_arrow1x_pngSize);
-    mPreOffImage    = juce::ImageCache::getFromMemory(BinaryData::pre_off1x_png, BinaryData::pre_off1x_pngSize);
-    mPreOnImage     = juce::ImageCache::getFromMemory(BinaryData::pre_on1x_png, BinaryData::pre_on1x_pngSize);
-}
-
 void GregEditor::setupComponents() {
     mPresetLabel.setFont(juce::Font(16.0f, juce::Font::bold));
     mPresetLabel.setJustificationType(juce::Justification::centred);
     mPresetLabel.setColour(juce::Label::textColourId, juce::Colours::grey);
     addAndMakeVisible(mPresetLabel);
 
+    mPowerButton.setClickingTogglesState(true);
+    mPowerButton.setToggleState(false, juce::dontSendNotification);
+    // Callback isn't really necessary for this button, but will be needed for the preset nav buttons
+    // mPowerButton.onClick = [this]() {};
+    addAndMakeVisible(mPowerButton);
+
+    mPreButton.setClickingTogglesState(true);
+    mPreButton.setToggleState(true, juce::dontSendNotification);
+    // mPreButton.onClick = [this]() {};
+    addAndMakeVisible(mPreButton);
+
+    mPresetLeftButton.onClick = [this]() { audioProcessor.stepPreset(-1); };
+    addAndMakeVisible(mPresetLeftButton);
+
+    mPresetRightButton.onClick = [this]() { audioProcessor.stepPreset(1); };
+    addAndMakeVisible(mPresetRightButton);
+
+    // Ranges and values come from the parameters, see createAttachments()
+    addAndMakeVisible(mDriveIndicator);
+    addAndMakeVisible(mToneIndicator);
+    addAndMakeVisible(mMixIndicator);
+
+    addAndMakeVisible(mInputMeter);
+    addAndMakeVisible(mReductionMeter);
+    addAndMakeVisible(mOutputMeter);
+
+    // The analyzer is optional, the audio thread only decimates samples for it while it's shown
+    mSpectrumDisplay.setInterceptsMouseClicks(false, false);
+    addChildComponent(mSpectrumDisplay);
+    mAnalyzerButton.setClickingTogglesState(true);
+    mAnalyzerButton.onClick = [this]() { setAnalyzerVisible(mAnalyzerButton.getToggleState()); };
+    addAndMakeVisible(mAnalyzerButton);
+
+    mTelemetryLabel.setFont(juce::Font(12.0f));
+    mTelemetryLabel.setJustificationType(juce::Justification::centredLeft);
+    mTelemetryLabel.setColour(juce::Label::textColourId, juce::Colours::grey);
+    addChildComponent(mTelemetryLabel);
+}
+
+void GregEditor::applyAssets() {
+    const auto& assets = *EditorAssets::getInstance();
+    applyButtonImages(assets.get(EditorAssets::Image::powerButton),
+                      assets.get(EditorAssets::Image::leftArrow),
+                      assets.get(EditorAssets::Image::rightArrow),
+                      assets.get(EditorAssets::Image::preOff),
+                      assets.get(EditorAssets::Image::preOn));
+}
+
+void GregEditor::loadAssetsSynchronously() {
+    const auto load = [](const void* data, int size) { return juce::ImageCache::getFromMemory(data, size); };
+
+    mSynchronousBackground = load(BinaryData::bg1x_png, BinaryData::bg1x_pngSize);
+    applyButtonImages(load(BinaryData::power_btn1x_png, BinaryData::power_btn1x_pngSize),
+                      load(BinaryData::left_arrow1x_png, BinaryData::left_arrow1x_pngSize),
+                      load(BinaryData::right_arrow1x_png, BinaryData::right_arrow1x_pngSize),
+                      load(BinaryData::pre_off1x_png, BinaryData::pre_off1x_pngSize),
+                      load(BinaryData::pre_on1x_png, BinaryData::pre_on1x_pngSize));
+}
+
+void GregEditor::applyButtonImages(const juce::Image& powerButton,
+                                   const juce::Image& leftArrow,
+                                   const juce::Image& rightArrow,
+                                   const juce::Image& preOff,
+                                   const juce::Image& preOn) {
     mPowerButton.setImages(false,
                            true,
                            true,
-                           mPowerButtonImage,
+                           powerButton,
                            1.0f,
                            juce::Colours::transparentBlack,
                            juce::Image(),
                            1.0f,
                            juce::Colours::transparentBlack,
-                           mPowerButtonImage,
+                           powerButton,
                            1.0f,
                            juce::Colours::darkgrey);
-    mPowerButton.setClickingTogglesState(true);
-    mPowerButton.setToggleState(false, juce::dontSendNotification);
-    // Callback isn't really necessary for this button, but will be needed for the preset nav buttons
-    // mPowerButton.onClick = [this]() {};
-    addAndMakeVisible(mPowerButton);
 
     mPreButton.setImages(false,
                          true,
                          true,
-                         mPreOffImage,
+                         preOff,
                          1.0f,
                          juce::Colours::transparentBlack,
                          juce::Image(),
                          1.0f,
                          juce::Colours::transparentBlack,
-                         mPreOnImage,
+                         preOn,
                          1.0f,
                          juce::Colours::transparentBlack);
-    mPreButton.setClickingTogglesState(true);
-    mPreButton.setToggleState(true, juce::dontSendNotification);
-    // mPreButton.onClick = [this]() {};
-    addAndMakeVisible(mPreButton);
 
     mPresetLeftButton.setImages(false,
                                 true,
                                 true,
-                                mLeftArrowImage,
+                                leftArrow,
                                 1.0f,
                                 juce::Colours::transparentWhite,
-                                mLeftArrowImage,
+                                leftArrow,
                                 0.78f,
                                 juce::Colours::transparentWhite,
-                                mLeftArrowImage,
+                                leftArrow,
                                 0.56f,
                                 juce::Colours::transparentWhite);
-    addAndMakeVisible(mPresetLeftButton);
 
     mPresetRightButton.setImages(false,
                                  true,
                                  true,
-                                 mRightArrowImage,
+                                 rightArrow,
                                  1.0f,
                                  juce::Colours::transparentWhite,
-                                 mRightArrowImage,
+                                 rightArrow,
                                  0.78f,
                                  juce::Colours::transparentWhite,
-                                 mRightArrowImage,
+                                 rightArrow,
                                  0.56f,
                                  juce::Colours::transparentWhite);
-    addAndMakeVisible(mPresetRightButton);
-
-    mDriveIndicator.setRange(0.0, 30.0, 0.1);
-    mDriveIndicator.setValue(0.0);
-    addAndMakeVisible(mDriveIndicator);
-
-    mToneIndicator.setRange(0.0, 100.0, 0.1);
-    mToneIndicator.setValue(0.0);
-    addAndMakeVisible(mToneIndicator);
 
-    mMixIndicator.setRange(0.0, 100.0, 0.1);
-    mMixIndicator.setValue(100.0);
-    addAndMakeVisible(mMixIndicator);
+    mAssetsApplied = true;
+    repaint();
 }
 
 void GregEditor::createAttachments() {
@@ -140,18 +236,92 @@ void GregEditor::createAttachments() {
                                                                              "pre",
                                                                              mPreButton);
 
-    mDriveAttachment =
-      std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.mParameters,
-                                                                             "drive",
-                                                                             mDriveIndicator);
-    mToneAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.mParameters,
-                                                                                             "tone",
-                                                                                             mToneIndicator);
-    mMixAttachment  = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.mParameters,
-                                                                                            "mix",
-                                                                                            mMixIndicator);
+    // Unlike a SliderAttachment, which repaints on every automation step, the knobs follow their parameters from
+    // timerCallback()
+    mDriveIndicator.attachToParameter(*audioProcessor.mParameters.getParameter("drive"));
+    mToneIndicator.attachToParameter(*audioProcessor.mParameters.getParameter("tone"));
+    mMixIndicator.attachToParameter(*audioProcessor.mParameters.getParameter("mix"));
+
     mOutputAttachment =
       std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.mParameters,
                                                                              "output",
                                                                              mOutputSlider);
+}
+
+void GregEditor::timerCallback() {
+    mDriveIndicator.syncToParameter();
+    mToneIndicator.syncToParameter();
+    mMixIndicator.syncToParameter();
+    updateMeters();
+
+    // Checked every frame until the decoding thread is done, that's one atomic load
+    if (!mAssetsApplied && EditorAssets::getInstance()->isReady()) applyAssets();
+
+    if (++mFramesSinceTelemetry < kFrameRateHz / kTelemetryRefreshHz) return;
+    mFramesSinceTelemetry = 0;
+    updateTelemetry();
+}
+
+void GregEditor::updateMeters() {
+    constexpr double kFrameSeconds = 1.0 / kFrameRateHz;
+    auto& meterFeed                = audioProcessor.getMeterFeed();
+    const auto numSummaries        = meterFeed.readSummaries(mSummaries.data(), static_cast<int>(mSummaries.size()));
+
+    // The loudest of every block since the last frame. Nothing queued (stopped transport) lets the meters fall.
+    MeterFeed::Summary loudest;
+    float reductionDb = 0.0f;
+
+    for (int i = 0; i < numSummaries; ++i) {
+        const auto& summary = mSummaries[static_cast<size_t>(i)];
+        loudest.inputPeak   = juce::jmax(loudest.inputPeak, summary.inputPeak);
+        loudest.inputRms    = juce::jmax(loudest.inputRms, summary.inputRms);
+        loudest.outputPeak  = juce::jmax(loudest.outputPeak, summary.outputPeak);
+        loudest.outputRms   = juce::jmax(loudest.outputRms, summary.outputRms);
+        reductionDb         = juce::jmax(reductionDb, summary.getGainReductionDb());
+    }
+
+    const auto toDb = [](float level) { return juce::Decibels::gainToDecibels(level, LevelMeter::kMinLevelDb); };
+    mInputMeter.update(toDb(loudest.inputPeak), toDb(loudest.inputRms), kFrameSeconds);
+    mOutputMeter.update(toDb(loudest.outputPeak), toDb(loudest.outputRms), kFrameSeconds);
+    mReductionMeter.update(reductionDb, reductionDb, kFrameSeconds);
+
+    if (!mSpectrumDisplay.isVisible()) return;
+
+    // At most one FFT per frame, however many samples arrived
+    if (mSpectrumDisplay.getSampleRate() != meterFeed.getAnalysisRate()) {
+        mSpectrumDisplay.prepare(meterFeed.getAnalysisRate());
+    }
+
+    const auto numSamples = meterFeed.readSamples(mAnalyzerSamples.data(), static_cast<int>(mAnalyzerSamples.size()));
+    mSpectrumDisplay.update(mAnalyzerSamples.data(), numSamples, kFrameSeconds);
+}
+
+void GregEditor::setAnalyzerVisible(bool visible) {
+    auto& meterFeed = audioProcessor.getMeterFeed();
+
+    // Samples left from when it was last shown would open with a gap in the middle
+    if (visible) meterFeed.readSamples(mAnalyzerSamples.data(), static_cast<int>(mAnalyzerSamples.size()));
+
+    mSpectrumDisplay.setVisible(visible);
+    meterFeed.setAnalyzerEnabled(visible);
+}
+
+void GregEditor::updateTelemetry() {
+    const auto& telemetry = audioProcessor.getTelemetry();
+    mTelemetryLabel.setVisible(telemetry.isEnabled());
+    if (!telemetry.isEnabled()) return;
+
+    using Stage = Telemetry::Stage;
+
+    juce::String text;
+    text << "DSP " << juce::String(telemetry.getLoad() * 100.0f, 1) << "% (peak "
+         << juce::String(telemetry.getPeakLoad() * 100.0f, 1) << "%)";
+    for (const auto stage : {Stage::upsample, Stage::tone, Stage::shape, Stage::downsample, Stage::mix}) {
+        text << "  " << Telemetry::getStageName(stage) << " " << juce::String(telemetry.getStageMicros(stage), 1)
+             << "us";
+    }
+    text << "  NaN " << juce::String(telemetry.getNonFiniteBlockCount()) << "  denormal "
+         << juce::String(telemetry.getDenormalBlockCount());
+
+    mTelemetryLabel.setText(text, juce::dontSendNotification);
 }
\ No newline at end of file
@@ -4,10 +4,13 @@
 #include <juce_gui_extra/juce_gui_extra.h>
 #include <juce_audio_processors/juce_audio_processors.h>
 
+#include "EditorAssets.hpp"
 #include "KnobIndicator.hpp"
+#include "MeterDisplay.hpp"
 #include "PluginProcessor.hpp"
 
-class GregEditor final : public juce::AudioProcessorEditor {
+class GregEditor final : public juce::AudioProcessorEditor,
+                         private juce::Timer {
 public:
     explicit GregEditor(GregProcessor&);
     ~GregEditor() override;
@@ -16,25 +19,63 @@ public:
     void resized() override;
     void updatePresetName();
 
+    /**
+     * How editors created from now on get their artwork. Synchronous is the path from before EditorAssets: every
+     * editor takes the six PNGs from ImageCache in its constructor and draws the background at full size on every
+     * paint. Only GregBench --editor-sync selects it, to time the old path. Message thread only.
+     */
+    enum class AssetLoading { shared, synchronous };
+    static void setAssetLoading(AssetLoading loading);
+
 private:
-    void loadImages();
+    static constexpr int kWidth  = 700;
+    static constexpr int kHeight = 460;
+
+    // Shown until EditorAssets has decoded the artwork
+    static constexpr juce::uint32 kPlaceholderColour = 0xff1c1c1c;
+
     void setupComponents();
+    void applyAssets();
+    void loadAssetsSynchronously();
+    void applyButtonImages(const juce::Image& powerButton,
+                           const juce::Image& leftArrow,
+                           const juce::Image& rightArrow,
+                           const juce::Image& preOff,
+                           const juce::Image& preOn);
     void createAttachments();
 
+    // The one place parameter changes and levels reach the screen: moves the knobs to the current values and the
+    // meters to the levels the audio thread queued since the last frame, at a capped frame rate however fast the host
+    // automates, and refreshes the telemetry readout while the processor's telemetry is enabled
+    void timerCallback() override;
+    void updateMeters();
+    void updateTelemetry();
+    void setAnalyzerVisible(bool visible);
+    static constexpr int kFrameRateHz        = 30;
+    static constexpr int kTelemetryRefreshHz = 4;
+    int mFramesSinceTelemetry                = 0;
+
     GregProcessor& audioProcessor;
 
-    juce::Image mBackgroundImage;
-    juce::Image mPowerButtonImage;
-    juce::Image mRightArrowImage;
-    juce::Image mLeftArrowImage;
-    juce::Image mPreOffImage;
-    juce::Image mPreOnImage;
+    bool mAssetsApplied = false;
+    juce::Image mBackground;             // The shared background, resampled to the editor's size in physical pixels
+    juce::Image mSynchronousBackground;  // Full size, only with AssetLoading::synchronous
 
     KnobIndicator mDriveIndicator;
     KnobIndicator mToneIndicator;
     KnobIndicator mMixIndicator;
     juce::Slider mOutputSlider;
 
+    LevelMeter mInputMeter {LevelMeter::Style::level};
+    LevelMeter mOutputMeter {LevelMeter::Style::level};
+    LevelMeter mReductionMeter {LevelMeter::Style::reduction};
+    SpectrumDisplay mSpectrumDisplay;
+    juce::TextButton mAnalyzerButton {"FFT"};
+
+    // Read out of the processor's MeterFeed every frame, sized once here
+    std::vector<MeterFeed::Summary> mSummaries = std::vector<MeterFeed::Summary>(MeterFeed::kSummaryRingSize);
+    std::vector<float> mAnalyzerSamples        = std::vector<float>(MeterFeed::kSampleRingSize);
+
     juce::ImageButton mPowerButton;
     juce::ImageButton mPresetLeftButton;
     juce::ImageButton mPresetRightButton;
@@ -45,10 +86,8 @@ private:
     juce::Label mMixLabel;
     juce::Label mOutputLabel;
     juce::Label mPresetLabel;
+    juce::Label mTelemetryLabel;
 
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> mDriveAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> mToneAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> mMixAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> mOutputAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> mPowerButtonAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> mPreButtonAttachment;
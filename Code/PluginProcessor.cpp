@@ -1,11 +1,49 @@
 #include "PluginProcessor.hpp"
 #include "PluginEditor.hpp"
+#include "AllocationGuard.hpp"
 
 GregProcessor::GregProcessor()
     : AudioProcessor(BusesProperties()
                        .withInput("Input", juce::AudioChannelSet::stereo(), true)
                        .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
-      mParameters(*this, nullptr, "Parameters", createParameterLayout()) {}
+      mParameters(*this, nullptr, "Parameters", createParameterLayout()) {
+    for (auto* parameter : getParameters()) {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter)) mStateParameters.add(ranged);
+    }
+
+    const auto resolve = [this](const juce::String& id) {
+        auto* value = mParameters.getRawParameterValue(id);
+        jassert(value != nullptr);  // ID missing from createParameterLayout()
+        return value;
+    };
+
+    mRawParameters.bypass        = resolve("bypass");
+    mRawParameters.pre           = resolve("pre");
+    mRawParameters.drive         = resolve("drive");
+    mRawParameters.tone          = resolve("tone");
+    mRawParameters.mix           = resolve("mix");
+    mRawParameters.output        = resolve("output");
+    mRawParameters.quality       = resolve("quality");
+    mRawParameters.filter        = resolve("filter");
+    mRawParameters.renderQuality = resolve("renderQuality");
+    mRawParameters.antialiasing  = resolve("antialiasing");
+    mRawParameters.shaper        = resolve("shaper");
+    mRawParameters.stereo        = resolve("stereo");
+    mRawParameters.sideDrive     = resolve("sideDrive");
+    mRawParameters.bands         = resolve("bands");
+
+    for (size_t i = 0; i < mRawParameters.crossovers.size(); ++i) {
+        mRawParameters.crossovers[i] = resolve("crossover" + juce::String(i + 1));
+    }
+    for (size_t i = 0; i < mRawParameters.bandDrives.size(); ++i) {
+        mRawParameters.bandDrives[i] = resolve("band" + juce::String(i + 1) + "Drive");
+        mRawParameters.bandMixes[i]  = resolve("band" + juce::String(i + 1) + "Mix");
+    }
+
+    const bool telemetryEnabled = juce::SystemStats::getEnvironmentVariable("GREG_TELEMETRY", {}).isNotEmpty();
+    mEngine.getTelemetry().setEnabled(telemetryEnabled);
+    mDoubleEngine.getTelemetry().setEnabled(telemetryEnabled);
+}
 
 GregProcessor::~GregProcessor() {}
 
@@ -26,53 +64,71 @@ bool GregProcessor::isMidiEffect() const {
 }
 
 double GregProcessor::getTailLengthSeconds() const {
-    return 0.0;
+    const auto sampleRate = getSampleRate();
+    return sampleRate > 0.0 ? getActiveEngine().getTailInSamples() / sampleRate : 0.0;
 }
 
 int GregProcessor::getNumPrograms() {
-    return 1;
+    return mPresets->size();
 }
 
 int GregProcessor::getCurrentProgram() {
-    return 0;
+    return mCurrentProgram;
 }
 
-void GregProcessor::setCurrentProgram(int index) {}
+void GregProcessor::setCurrentProgram(int index) {
+    const auto* preset = mPresets->getPreset(index);
+    if (preset == nullptr) return;
 
-const juce::String GregProcessor::getProgramName(int index) {
-    return {};
-}
+    mCurrentProgram = index;
 
-void GregProcessor::changeProgramName(int index, const juce::String& newName) {}
+    // Update the host facing parameters first, so the blocks after the switch read what the snapshot carries
+    const auto setValue = [this](const juce::String& id, float value) {
+        if (auto* parameter = mParameters.getParameter(id)) {
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        }
+    };
 
-void GregProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) {
-    mSampleRate = sampleRate;
+    setValue("drive", preset->drive);
+    setValue("tone", preset->tone);
+    setValue("mix", preset->mix);
+    setValue("output", preset->output);
+    setValue("pre", preset->isFilterPre ? 1.0f : 0.0f);
+
+    mPendingPreset = preset;
+    setCurrentPresetName(preset->name);
+}
 
-    // Initialize smoothed parameters
-    double oversampledRate = sampleRate * kOversampleOrder;
+void GregProcessor::stepPreset(int delta) {
+    const auto numPresets = mPresets->size();
+    setCurrentProgram(((mCurrentProgram + delta) % numPresets + numPresets) % numPresets);
+    updateHostDisplay(ChangeDetails().withProgramChanged(true));
+}
 
-    mDriveSmoothed.reset(oversampledRate, 0.01);
-    mToneSmoothed.reset(oversampledRate, 0.01);
-    mMixSmoothed.reset(oversampledRate, 0.01);
-    mOutputSmoothed.reset(oversampledRate, 0.01);
+const juce::String GregProcessor::getProgramName(int index) {
+    const auto* preset = mPresets->getPreset(index);
+    return preset != nullptr ? preset->name : juce::String();
+}
 
-    // Initialize with current parameter values
-    mDriveSmoothed.setCurrentAndTargetValue(mParameters.getRawParameterValue("drive")->load());
-    mToneSmoothed.setCurrentAndTargetValue(mParameters.getRawParameterValue("tone")->load());
-    mMixSmoothed.setCurrentAndTargetValue(mParameters.getRawParameterValue("mix")->load());
-    mOutputSmoothed.setCurrentAndTargetValue(mParameters.getRawParameterValue("output")->load());
+void GregProcessor::changeProgramName(int index, const juce::String& newName) {}
 
-    mOversampling =
-      std::make_unique<juce::dsp::Oversampling<float>>(getTotalNumInputChannels(),
-                                                       kOversampleOrder,
-                                                       juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple,
-                                                       true);
+void GregProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) {
+    // Oversamplers, dry path and filter lanes are all sized for the layout the host settled on
+    const auto numChannels = getTotalNumInputChannels();
+    const auto parameters  = getEngineParameters();
+
+    // The tables take a moment to build, do it before playback if they're already switched on
+    if (parameters.antialiasingOrder > 0) AntiderivativeShaper::buildTable();
+    if (parameters.useWaveshaperTable) WaveshaperTable::build();
+
+    if (isUsingDoublePrecision()) {
+        mDoubleEngine.prepare(sampleRate, numChannels, samplesPerBlock, parameters, isNonRealtime());
+    } else {
+        mEngine.prepare(sampleRate, numChannels, samplesPerBlock, parameters, isNonRealtime());
+    }
 
-    juce::dsp::ProcessSpec spec {};
-    spec.sampleRate       = oversampledRate;
-    spec.maximumBlockSize = samplesPerBlock * kOversampleOrder;
-    spec.numChannels      = getTotalNumOutputChannels();
-    mOversampling->initProcessing(spec.maximumBlockSize);
+    mMeterFeed.prepare(sampleRate, samplesPerBlock);
+    setLatencySamples(getActiveEngine().getLatencyInSamples());
 }
 
 void GregProcessor::releaseResources() {
@@ -80,100 +136,102 @@ void GregProcessor::releaseResources() {
 }
 
 bool GregProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const {
-    // Support stereo input and output
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo()) return false;
+    // Anything from mono to immersive, the DSP treats channels independently. Input and output have to match, since
+    // the dry signal is mixed back channel for channel.
+    const auto& output = layouts.getMainOutputChannelSet();
+    if (output.isDisabled() || output.size() > kMaxChannels) return false;
 
-    if (layouts.getMainInputChannelSet() != juce::AudioChannelSet::stereo()) return false;
+    return layouts.getMainInputChannelSet() == output;
+}
 
+bool GregProcessor::supportsDoublePrecisionProcessing() const {
     return true;
 }
 
 void GregProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) {
-    juce::ScopedNoDenormals noDenormals;
-
-    const bool isBypassed = mParameters.getRawParameterValue("bypass")->load() > 0.5f;
-    if (isBypassed) return;
-
-    const bool isFilterPre = mParameters.getRawParameterValue("pre")->load() < 0.5f;
+    process(buffer, mEngine);
+}
 
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
+void GregProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages) {
+    process(buffer, mDoubleEngine);
+}
 
-    // Get current parameter values
-    float currentDrive  = mParameters.getRawParameterValue("drive")->load();
-    float currentTone   = mParameters.getRawParameterValue("tone")->load();
-    float currentMix    = mParameters.getRawParameterValue("mix")->load();
-    float currentOutput = mParameters.getRawParameterValue("output")->load();
+template<typename SampleType>
+void GregProcessor::process(juce::AudioBuffer<SampleType>& buffer, GregEngine<SampleType>& engine) {
+    ScopedAllocationGuard allocationGuard;
+    juce::ScopedNoDenormals noDenormals;
 
-    // Update smoothed values if parameters changed
-    if (currentDrive != mPreviousDrive) {
-        mDriveSmoothed.setTargetValue(currentDrive);
-        mPreviousDrive = currentDrive;
-    }
-    if (currentTone != mPreviousTone) {
-        mToneSmoothed.setTargetValue(currentTone);
-        mPreviousTone = currentTone;
-    }
-    if (currentMix != mPreviousMix) {
-        mMixSmoothed.setTargetValue(currentMix);
-        mPreviousMix = currentMix;
+    auto parameters   = getEngineParameters();
+    auto transition   = GregEngineBase::Transition::smoothed;
+    const auto preset = mPendingPreset.exchange(nullptr);
+    if (preset != nullptr) {
+        preset->applyTo(parameters);
+        transition = GregEngineBase::Transition::withinBlock;
     }
-    if (currentOutput != mPreviousOutput) {
-        mOutputSmoothed.setTargetValue(currentOutput);
-        mPreviousOutput = currentOutput;
-    }
-
-    // Store dry signal for mixing
-    juce::AudioBuffer<float> dryBuffer;
-    dryBuffer.makeCopyOf(buffer);
-
-    juce::dsp::AudioBlock<float> block(buffer);
-    juce::dsp::AudioBlock<float> dryBlock(dryBuffer);
-
-    // Get oversampled block
-    auto oversampledBlock = mOversampling->processSamplesUp(block);
 
-    // Process each sample with smoothed parameters
-    for (int sample = 0; sample < oversampledBlock.getNumSamples(); ++sample) {
-        // Get smoothed parameter values for this sample
-        float smoothedDrive  = mDriveSmoothed.getNextValue();
-        float smoothedTone   = mToneSmoothed.getNextValue();
-        float smoothedMix    = mMixSmoothed.getNextValue();
-        float smoothedOutput = mOutputSmoothed.getNextValue();
+    // Switched on during playback: the engine shapes directly until the background build has finished
+    const bool needsTable = (parameters.antialiasingOrder > 0 && !AntiderivativeShaper::isTableReady())
+                         || (parameters.useWaveshaperTable && !WaveshaperTable::isReady());
 
-        float driveLinear  = juce::Decibels::decibelsToGain(smoothedDrive);
-        float outputLinear = juce::Decibels::decibelsToGain(smoothedOutput);
-        float mixRatio     = smoothedMix * 0.01f;  // Convert percentage to 0-1
+    mMeterFeed.beginBlock(buffer);
+    const bool latencyChanged = engine.process(buffer, parameters, isNonRealtime(), transition);
 
-        for (int channel = 0; channel < oversampledBlock.getNumChannels(); ++channel) {
-            auto* channelData = oversampledBlock.getChannelPointer(channel);
+    // The reduction meter compares the output with a straight line at the curve's steepest slope
+    const auto drive        = juce::Decibels::decibelsToGain(parameters.drive);
+    const auto linearGainDb = juce::Decibels::gainToDecibels(SaturationKernel::getSmallSignalGain(drive))
+                            + parameters.output;
+    mMeterFeed.endBlock(buffer, parameters.isBypassed ? 0.0f : linearGainDb);
 
-            // Apply saturation
-            float processedSample = applySaturation(channelData[sample], driveLinear);
-
-            // TODO: Tone filter
-
-            // Apply output gain
-            processedSample *= outputLinear;
-
-            channelData[sample] = processedSample;
-        }
+    if (latencyChanged || needsTable) {
+        triggerAsyncUpdate();  // The new latency is reported to the host from the message thread
     }
+}
 
-    // Downsample back to original rate
-    mOversampling->processSamplesDown(block);
+GregEngineBase::Parameters GregProcessor::getEngineParameters() const {
+    GregEngineBase::Parameters parameters;
+    parameters.drive       = mRawParameters.drive->load();
+    parameters.tone        = mRawParameters.tone->load();
+    parameters.mix         = mRawParameters.mix->load();
+    parameters.output      = mRawParameters.output->load();
+    parameters.isFilterPre = mRawParameters.pre->load() > 0.5f;
+    parameters.isBypassed  = mRawParameters.bypass->load() > 0.5f;
+
+    // Choice index i selects 2^i times oversampling
+    parameters.oversamplingOrder       = static_cast<int>(mRawParameters.quality->load());
+    parameters.renderOversamplingOrder = static_cast<int>(mRawParameters.renderQuality->load());
+    parameters.antialiasingOrder       = static_cast<int>(mRawParameters.antialiasing->load());
+    parameters.useWaveshaperTable      = mRawParameters.shaper->load() > 0.5f;
+
+    // Choices in the order of GregEngineBase::StereoMode
+    parameters.stereoMode = static_cast<GregEngineBase::StereoMode>(static_cast<int>(mRawParameters.stereo->load()));
+    parameters.sideDrive  = mRawParameters.sideDrive->load();
+
+    // Choice 0 is the full band path, then 3 and 4 bands
+    const auto bandsChoice    = static_cast<int>(mRawParameters.bands->load());
+    parameters.bands.numBands = bandsChoice == 0 ? 1 : bandsChoice + 2;
+
+    for (size_t i = 0; i < mRawParameters.crossovers.size(); ++i) {
+        parameters.bands.crossovers[i] = mRawParameters.crossovers[i]->load();
+    }
+    for (size_t i = 0; i < mRawParameters.bandDrives.size(); ++i) {
+        parameters.bands.driveOffsets[i] = mRawParameters.bandDrives[i]->load();
+        parameters.bands.mixes[i]        = mRawParameters.bandMixes[i]->load();
+    }
 
-    // Apply dry/wet mixing at original sample rate
-    float mixRatio = mMixSmoothed.getCurrentValue() * 0.01f;
+    using FilterType      = OversamplerBankBase::FilterType;
+    parameters.filterType = mRawParameters.filter->load() > 0.5f ? FilterType::linearPhase : FilterType::minimumPhase;
+    return parameters;
+}
 
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
-        auto* wetData = buffer.getWritePointer(channel);
-        auto* dryData = dryBuffer.getReadPointer(channel);
+void GregProcessor::handleAsyncUpdate() {
+    // Switched on during playback: build on a background thread, the engine shapes directly until the table is ready
+    if (mRawParameters.antialiasing->load() > 0.5f) AntiderivativeShaper::buildTableAsync();
+    if (mRawParameters.shaper->load() > 0.5f) WaveshaperTable::buildAsync();
+    setLatencySamples(getActiveEngine().getLatencyInSamples());
+}
 
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample) {
-            wetData[sample] = wetData[sample] * mixRatio + dryData[sample] * (1.0f - mixRatio);
-        }
-    }
+juce::AudioProcessorParameter* GregProcessor::getBypassParameter() const {
+    return mParameters.getParameter("bypass");
 }
 
 bool GregProcessor::hasEditor() const {
@@ -185,21 +243,53 @@ juce::AudioProcessorEditor* GregProcessor::createEditor() {
 }
 
 void GregProcessor::getStateInformation(juce::MemoryBlock& destData) {
-    // Save plugin state here
-    const auto state = mParameters.copyState();
+    StateCodec::State state;
+    state.presetName = mCurrentPresetName;
+    state.parameters.reserve(static_cast<size_t>(mStateParameters.size()));
+
+    for (auto* parameter : mStateParameters) {
+        state.parameters.emplace_back(parameter->getParameterID(), parameter->convertFrom0to1(parameter->getValue()));
+    }
+
+    StateCodec::write(state, destData);
+}
+
+void GregProcessor::getXmlStateInformation(juce::MemoryBlock& destData) {
+    auto state = mParameters.copyState();
+    state.setProperty("preset", mCurrentPresetName, nullptr);
     const std::unique_ptr<juce::XmlElement> xml(state.createXml());
     copyXmlToBinary(*xml, destData);
 }
 
 void GregProcessor::setStateInformation(const void* data, int sizeInBytes) {
-    // Restore plugin state here
-    std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
-
-    if (xmlState != nullptr) {
-        if (xmlState->hasTagName(mParameters.state.getType())) {
-            mParameters.replaceState(juce::ValueTree::fromXml(*xmlState));
+    StateCodec::State state;
+
+    // Fast path: set the parameters straight from the binary values, no ValueTree or XML involved
+    if (StateCodec::read(data, static_cast<size_t>(juce::jmax(0, sizeInBytes)), state)) {
+        for (const auto& [id, value] : state.parameters) {
+            if (auto* parameter = mParameters.getParameter(id)) {
+                parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+            }
         }
+
+        mCurrentProgram = juce::jmax(0, mPresets->indexOf(state.presetName));
+        setCurrentPresetName(state.presetName);
+        return;
     }
+
+    // Sessions saved before the binary format
+    if (const auto xmlState = getXmlFromBinary(data, sizeInBytes)) setStateFromXml(*xmlState);
+}
+
+void GregProcessor::setStateFromXml(const juce::XmlElement& xmlState) {
+    if (!xmlState.hasTagName(mParameters.state.getType())) return;
+
+    mParameters.replaceState(juce::ValueTree::fromXml(xmlState));
+
+    // The values may have been edited since, the name just says which preset they started from
+    const auto presetName = xmlState.getStringAttribute("preset", mCurrentPresetName);
+    mCurrentProgram       = juce::jmax(0, mPresets->indexOf(presetName));
+    setCurrentPresetName(presetName);
 }
 
 void GregProcessor::setCurrentPresetName(const juce::String& name) {
@@ -239,13 +329,82 @@ juce::AudioProcessorValueTreeState::ParameterLayout GregProcessor::createParamet
                                                                  0.0f,
                                                                  "dB"));
 
-    return {params.begin(), params.end()};
-}
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("quality",
+                                                                  "Quality",
+                                                                  juce::StringArray {"1x", "2x", "4x", "8x", "16x"},
+                                                                  1));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("filter",
+                                                                  "Filter",
+                                                                  juce::StringArray {"Min Phase", "Linear Phase"},
+                                                                  1));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("renderQuality",
+                                                                  "Render Quality",
+                                                                  juce::StringArray {"1x", "2x", "4x", "8x", "16x"},
+                                                                  3));
+
+    // Antiderivative anti-aliasing, on top of whichever oversampling factor is selected
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("antialiasing",
+                                                                  "Anti-aliasing",
+                                                                  juce::StringArray {"Off", "ADAA", "ADAA 2"},
+                                                                  0));
+
+    // Realtime shaping from the precomputed curve table instead of evaluating the curve
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("shaper",
+                                                                  "Shaper",
+                                                                  juce::StringArray {"Curve", "Table"},
+                                                                  0));
+
+    // Stereo handling of the full band shaper, the side drive is an offset on drive for mid/side
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("stereo",
+                                                                  "Stereo",
+                                                                  juce::StringArray {"Stereo", "Mid/Side", "Linked"},
+                                                                  0));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("sideDrive",
+                                                                 "Side Drive",
+                                                                 juce::NormalisableRange<float>(-12.0f, 12.0f, 0.1f),
+                                                                 0.0f,
+                                                                 "dB"));
+
+    // Multiband: band count, crossovers and a drive offset and mix per band
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("bands",
+                                                                  "Bands",
+                                                                  juce::StringArray {"Off", "3 Bands", "4 Bands"},
+                                                                  0));
+
+    const MultibandSaturatorBase::Settings defaultBands;
+    for (size_t i = 0; i < defaultBands.crossovers.size(); ++i) {
+        juce::NormalisableRange<float> range(20.0f, 20000.0f, 1.0f);
+        range.setSkewForCentre(1000.0f);
+
+        const auto number = juce::String(i + 1);
+        params.push_back(std::make_unique<juce::AudioParameterFloat>("crossover" + number,
+                                                                     "Crossover " + number,
+                                                                     range,
+                                                                     defaultBands.crossovers[i],
+                                                                     "Hz"));
+    }
+
+    const juce::NormalisableRange<float> offsetRange(-12.0f, 12.0f, 0.1f);
+    const juce::NormalisableRange<float> mixRange(0.0f, 100.0f, 0.1f);
+
+    for (size_t i = 0; i < defaultBands.driveOffsets.size(); ++i) {
+        const auto number = juce::String(i + 1);
+        params.push_back(std::make_unique<juce::AudioParameterFloat>("band" + number + "Drive",
+                                                                     "Band " + number + " Drive",
+                                                                     offsetRange,
+                                                                     defaultBands.driveOffsets[i],
+                                                                     "dB"));
+        params.push_back(std::make_unique<juce::AudioParameterFloat>("band" + number + "Mix",
+                                                                     "Band " + number + " Mix",
+                                                                     mixRange,
+                                                                     defaultBands.mixes[i],
+                                                                     "%"));
+    }
 
-float GregProcessor::applySaturation(float input, float drive) {
-    float fundamental = input;
-    float harmonic    = std::sin(input * drive * 2.0f);
-    return std::tanh((fundamental + harmonic * 0.3f) * drive);
+    return {params.begin(), params.end()};
 }
 
 // This creates new instances of the plugin
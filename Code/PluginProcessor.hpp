@@ -4,7 +4,13 @@
 #include <juce_audio_utils/juce_audio_utils.h>
 #include <juce_dsp/juce_dsp.h>
 
-class GregProcessor : public juce::AudioProcessor {
+#include "GregEngine.hpp"
+#include "MeterFeed.hpp"
+#include "PresetBank.hpp"
+#include "StateCodec.hpp"
+
+class GregProcessor : public juce::AudioProcessor,
+                      private juce::AsyncUpdater {
 public:
     GregProcessor();
     ~GregProcessor() override;
@@ -15,6 +21,13 @@ public:
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
 
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    /** Hosts that mix in 64 bit get a double precision engine instead of converting every block. */
+    bool supportsDoublePrecisionProcessing() const override;
+
+    /** Hands the host's bypass switch to our own parameter, so it gets the same crossfade instead of a hard cut. */
+    juce::AudioProcessorParameter* getBypassParameter() const override;
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -32,41 +45,105 @@ public:
     const juce::String getProgramName(int index) override;
     void changeProgramName(int index, const juce::String& newName) override;
 
+    /** Saves the compact binary state, see StateCodec. setStateInformation() still reads the older XML states. */
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
+    /** Saves the state in the older XML format, e.g. for comparison or for tools that want readable state. */
+    void getXmlStateInformation(juce::MemoryBlock& destData);
+
     juce::String getCurrentPresetName() const {
         return mCurrentPresetName;
     }
 
     void setCurrentPresetName(const juce::String& name);
 
+    /** Moves through the preset list by delta, wrapping around at either end. Message thread only. */
+    void stepPreset(int delta);
+
+    /** Switches between the exact scalar shaper and the SIMD approximation, e.g. to compare the two. */
+    void setSaturationMode(SaturationKernel::Mode mode) {
+        mEngine.setSaturationMode(mode);
+        mDoubleEngine.setSaturationMode(mode);
+    }
+
+    /** Per-block timing and signal health. Off by default, or on when GREG_TELEMETRY is set in the environment. */
+    Telemetry& getTelemetry() {
+        return getActiveEngine().getTelemetry();
+    }
+
+    /** Input, output and reduction levels plus analyzer samples for the editor. Measures only while it's active. */
+    MeterFeed& getMeterFeed() {
+        return mMeterFeed;
+    }
+
     juce::AudioProcessorValueTreeState mParameters;
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
 private:
-    static constexpr size_t kOversampleOrder = 4;
+    // 9.1.6 and everything smaller. Every channel costs its own oversampler memory at each quality setting.
+    static constexpr int kMaxChannels = 16;
 
     juce::String mCurrentPresetName {"Init"};
 
-    // Add your parameters here
-    float mGain        = 1.0f;
-    double mSampleRate = 44100;
-    std::unique_ptr<juce::dsp::Oversampling<float>> mOversampling;
+    // One engine per precision, only the one matching getProcessingPrecision() is prepared and run
+    GregEngine<float> mEngine;
+    GregEngine<double> mDoubleEngine;
 
-    // Smoothed parameters
-    juce::SmoothedValue<float> mDriveSmoothed;
-    juce::SmoothedValue<float> mToneSmoothed;
-    juce::SmoothedValue<float> mMixSmoothed;
-    juce::SmoothedValue<float> mOutputSmoothed;
+    MeterFeed mMeterFeed;
 
-    // Previous parameter values for change detection
-    float mPreviousDrive  = 0.0f;
-    float mPreviousTone   = 0.0f;
-    float mPreviousMix    = 100.0f;
-    float mPreviousOutput = 0.0f;
+    GregEngineBase& getActiveEngine() {
+        return isUsingDoublePrecision() ? static_cast<GregEngineBase&>(mDoubleEngine) : mEngine;
+    }
+
+    const GregEngineBase& getActiveEngine() const {
+        return isUsingDoublePrecision() ? static_cast<const GregEngineBase&>(mDoubleEngine) : mEngine;
+    }
 
-    static float applySaturation(float input, float drive);
+    template<typename SampleType>
+    void process(juce::AudioBuffer<SampleType>& buffer, GregEngine<SampleType>& engine);
+
+    // One bank for every instance in the process, built by the first and released with the last
+    juce::SharedResourcePointer<PresetBank> mPresets;
+    int mCurrentProgram = 0;
+
+    // The preset just selected, picked up by the next processBlock and applied within that block. Presets live as
+    // long as the bank, so handing over the pointer is all the synchronisation needed.
+    std::atomic<const PresetBank::Preset*> mPendingPreset {nullptr};
+
+    // The APVTS values behind every parameter, looked up once in the constructor rather than by ID per block
+    struct RawParameters {
+        std::atomic<float>* bypass        = nullptr;
+        std::atomic<float>* pre           = nullptr;
+        std::atomic<float>* drive         = nullptr;
+        std::atomic<float>* tone          = nullptr;
+        std::atomic<float>* mix           = nullptr;
+        std::atomic<float>* output        = nullptr;
+        std::atomic<float>* quality       = nullptr;
+        std::atomic<float>* filter        = nullptr;
+        std::atomic<float>* renderQuality = nullptr;
+        std::atomic<float>* antialiasing  = nullptr;
+        std::atomic<float>* shaper        = nullptr;
+        std::atomic<float>* stereo        = nullptr;
+        std::atomic<float>* sideDrive     = nullptr;
+        std::atomic<float>* bands         = nullptr;
+
+        std::array<std::atomic<float>*, MultibandSaturatorBase::kMaxCrossovers> crossovers {};
+        std::array<std::atomic<float>*, MultibandSaturatorBase::kMaxBands> bandDrives {};
+        std::array<std::atomic<float>*, MultibandSaturatorBase::kMaxBands> bandMixes {};
+    };
+
+    RawParameters mRawParameters;
+
+    /** Reads every parameter into one snapshot, the engine compares it with the previous block's as a whole. */
+    GregEngineBase::Parameters getEngineParameters() const;
+
+    // Every parameter, in layout order, for the binary state
+    juce::Array<juce::RangedAudioParameter*> mStateParameters;
+
+    void setStateFromXml(const juce::XmlElement& xmlState);
+
+    void handleAsyncUpdate() override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GregProcessor)
 };
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "PresetBank.hpp"
+
+namespace {
+    // Same layout as a saved plugin state, so a user preset file can be moved into the factory list as is
+    constexpr const char* kFactoryPresets = R"(
+<Presets>
+  <Parameters name="Init">
+    <PARAM id="drive" value="0"/> <PARAM id="tone" value="100"/> <PARAM id="mix" value="100"/>
+    <PARAM id="output" value="0"/> <PARAM id="pre" value="0"/>
+  </Parameters>
+  <Parameters name="Warm Glue">
+    <PARAM id="drive" value="6"/> <PARAM id="tone" value="55"/> <PARAM id="mix" value="100"/>
+    <PARAM id="output" value="-2"/> <PARAM id="pre" value="0"/>
+  </Parameters>
+  <Parameters name="Dark Tape">
+    <PARAM id="drive" value="9"/> <PARAM id="tone" value="25"/> <PARAM id="mix" value="100"/>
+    <PARAM id="output" value="-3"/> <PARAM id="pre" value="1"/>
+  </Parameters>
+  <Parameters name="Crunch">
+    <PARAM id="drive" value="15"/> <PARAM id="tone" value="70"/> <PARAM id="mix" value="100"/>
+    <PARAM id="output" value="-6"/> <PARAM id="pre" value="0"/>
+  </Parameters>
+  <Parameters name="Parallel Grit">
+    <PARAM id="drive" value="20"/> <PARAM id="tone" value="60"/> <PARAM id="mix" value="40"/>
+    <PARAM id="output" value="-2"/> <PARAM id="pre" value="0"/>
+  </Parameters>
+  <Parameters name="Fuzz Wall">
+    <PARAM id="drive" value="28"/> <PARAM id="tone" value="80"/> <PARAM id="mix" value="100"/>
+    <PARAM id="output" value="-10"/> <PARAM id="pre" value="0"/>
+  </Parameters>
+</Presets>
+)";
+}  // namespace
+
+PresetBank::PresetBank() {
+    if (const auto factory = juce::parseXML(juce::String(kFactoryPresets))) {
+        for (const auto* state : factory->getChildIterator()) {
+            mPresets.push_back(fromState(*state, state->getStringAttribute("name")));
+        }
+    }
+
+    // User presets follow the factory ones, sorted by name
+    auto files = getUserPresetDirectory().findChildFiles(juce::File::findFiles, false, "*.xml");
+    files.sort();
+
+    for (const auto& file : files) {
+        if (const auto state = juce::parseXML(file)) {
+            mPresets.push_back(fromState(*state, file.getFileNameWithoutExtension()));
+        }
+    }
+
+    jassert(!mPresets.empty());
+}
+
+const PresetBank::Preset* PresetBank::getPreset(int index) const {
+    if (!juce::isPositiveAndBelow(index, size())) return nullptr;
+    return &mPresets[static_cast<size_t>(index)];
+}
+
+int PresetBank::indexOf(const juce::String& name) const {
+    for (size_t i = 0; i < mPresets.size(); ++i) {
+        if (mPresets[i].name == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+PresetBank::Preset PresetBank::fromState(const juce::XmlElement& state, const juce::String& name) {
+    Preset preset;
+    preset.name = name;
+
+    for (const auto* param : state.getChildWithTagNameIterator("PARAM")) {
+        const auto id    = param->getStringAttribute("id");
+        const auto value = static_cast<float>(param->getDoubleAttribute("value"));
+
+        if (id == "drive") preset.drive = value;
+        else if (id == "tone") preset.tone = value;
+        else if (id == "mix") preset.mix = value;
+        else if (id == "output") preset.output = value;
+        else if (id == "pre") preset.isFilterPre = value > 0.5f;
+    }
+
+    return preset;
+}
+
+juce::File PresetBank::getUserPresetDirectory() {
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+      .getChildFile("ATOM Factory")
+      .getChildFile("Greg")
+      .getChildFile("Presets");
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include "GregEngine.hpp"
+
+/**
+ * Greg's presets, parsed once into compact parameter snapshots.
+ *
+ * Holds the factory presets plus any user presets (saved plugin states as .xml) found in getUserPresetDirectory().
+ * Everything is parsed in the constructor and the list never changes afterwards, so a Preset pointer stays valid
+ * for the bank's lifetime and can be handed to the audio thread as is. The plugin shares one bank between all its
+ * instances through a juce::SharedResourcePointer, so the parsing and the directory scan happen once per process.
+ */
+class PresetBank {
+public:
+    /** The sound of a preset. Quality settings (oversampling, filter type) stay as the user set them. */
+    struct Preset {
+        juce::String name;
+        float drive      = 0.0f;
+        float tone       = 100.0f;
+        float mix        = 100.0f;
+        float output     = 0.0f;
+        bool isFilterPre = false;
+
+        void applyTo(GregEngineBase::Parameters& parameters) const {
+            parameters.drive       = drive;
+            parameters.tone        = tone;
+            parameters.mix         = mix;
+            parameters.output      = output;
+            parameters.isFilterPre = isFilterPre;
+        }
+    };
+
+    PresetBank();
+
+    int size() const {
+        return static_cast<int>(mPresets.size());
+    }
+
+    /** Returns nullptr for an out of range index. */
+    const Preset* getPreset(int index) const;
+
+    /** Returns -1 if there's no preset with that name. */
+    int indexOf(const juce::String& name) const;
+
+    /** Reads a preset from a saved plugin state, the APVTS tree GregProcessor::getStateInformation writes. */
+    static Preset fromState(const juce::XmlElement& state, const juce::String& name);
+
+    static juce::File getUserPresetDirectory();
+
+private:
+    std::vector<Preset> mPresets;
+};
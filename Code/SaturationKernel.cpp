@@ -0,0 +1,401 @@
+#include "SaturationKernel.hpp"
+
+namespace {
+    constexpr float kPi          = 3.14159265358979323846f;
+    constexpr float kInvTwoPi    = 0.15915494309189533577f;
+    constexpr float kTwoPiHigh   = 6.28125f;  // Exactly representable upper part of 2 pi
+    constexpr float kTwoPiLow    = 0.0019353071795864769f;
+    constexpr float kMaxSinInput = 4096.0f;
+    // Keeps the value handed to truncate positive so that truncate behaves like floor
+    constexpr float kRoundOffset = 1024.0f;
+    constexpr float kMaxTanhInput = 9.0f;
+
+    // Taylor coefficients of sin, accurate to float precision on [-pi/2, pi/2]
+    constexpr float kSin3  = -1.6666666666666667e-01f;
+    constexpr float kSin5  = 8.3333333333333333e-03f;
+    constexpr float kSin7  = -1.9841269841269841e-04f;
+    constexpr float kSin9  = 2.7557319223985893e-06f;
+    constexpr float kSin11 = -2.5052108385441720e-08f;
+
+    // Scalar and SIMD flavours of the few operations the approximations need, for float and double
+    template<typename T>
+    T splat(float value) {
+        if constexpr (std::is_floating_point_v<T>) return static_cast<T>(value);
+        else return T::expand(value);
+    }
+
+    template<typename T>
+    T min(T a, T b) {
+        return juce::jmin(a, b);
+    }
+
+    template<typename T>
+    T max(T a, T b) {
+        return juce::jmax(a, b);
+    }
+
+    template<typename T>
+    T truncate(T a) {
+        return std::trunc(a);
+    }
+
+    template<typename T>
+    T divide(T numerator, T denominator) {
+        return numerator / denominator;
+    }
+
+#if JUCE_USE_SIMD
+    template<typename Element>
+    using Vector = juce::dsp::SIMDRegister<Element>;
+
+    template<typename Element>
+    Vector<Element> min(Vector<Element> a, Vector<Element> b) {
+        return Vector<Element>::min(a, b);
+    }
+
+    template<typename Element>
+    Vector<Element> max(Vector<Element> a, Vector<Element> b) {
+        return Vector<Element>::max(a, b);
+    }
+
+    template<typename Element>
+    Vector<Element> truncate(Vector<Element> a) {
+        return Vector<Element>::truncate(a);
+    }
+
+    template<typename Element>
+    Vector<Element> divideLanes(Vector<Element> numerator, Vector<Element> denominator) {
+        for (size_t i = 0; i < Vector<Element>::SIMDNumElements; ++i) {
+            numerator.set(i, numerator.get(i) / denominator.get(i));
+        }
+        return numerator;
+    }
+
+    // SIMDRegister has no division, so go to the native type JUCE selected for this target
+    template<typename Element>
+    Vector<Element> divide(Vector<Element> numerator, Vector<Element> denominator) {
+        using Native            = typename Vector<Element>::vSIMDType;
+        constexpr bool isDouble = std::is_same_v<Element, double>;
+    #if JUCE_INTEL
+        if constexpr (isDouble && sizeof(Native) == sizeof(__m256d)) {
+            return Vector<Element>::fromNative(_mm256_div_pd(numerator.value, denominator.value));
+        } else if constexpr (isDouble) {
+            return Vector<Element>::fromNative(_mm_div_pd(numerator.value, denominator.value));
+        } else if constexpr (sizeof(Native) == sizeof(__m256)) {
+            return Vector<Element>::fromNative(_mm256_div_ps(numerator.value, denominator.value));
+        } else {
+            return Vector<Element>::fromNative(_mm_div_ps(numerator.value, denominator.value));
+        }
+    #elif JUCE_ARM && JUCE_64BIT
+        if constexpr (isDouble) return Vector<Element>::fromNative(vdivq_f64(numerator.value, denominator.value));
+        else return Vector<Element>::fromNative(vdivq_f32(numerator.value, denominator.value));
+    #elif JUCE_ARM
+        // 32-bit NEON has no double lanes, JUCE falls back to plain arrays there
+        if constexpr (isDouble) {
+            return divideLanes(numerator, denominator);
+        } else {
+            // Reciprocal estimate refined with two Newton-Raphson steps
+            Native reciprocal = vrecpeq_f32(denominator.value);
+            reciprocal        = vmulq_f32(vrecpsq_f32(denominator.value, reciprocal), reciprocal);
+            reciprocal        = vmulq_f32(vrecpsq_f32(denominator.value, reciprocal), reciprocal);
+            return Vector<Element>::fromNative(vmulq_f32(numerator.value, reciprocal));
+        }
+    #else
+        return divideLanes(numerator, denominator);
+    #endif
+    }
+
+    // The oversampler's buffers and our scratch curves carry no alignment guarantee, so bounce through the stack
+    template<typename Element>
+    Vector<Element> load(const Element* source) {
+        alignas(sizeof(Vector<Element>)) Element aligned[Vector<Element>::SIMDNumElements];
+        std::memcpy(aligned, source, sizeof(aligned));
+        return Vector<Element>::fromRawArray(aligned);
+    }
+
+    template<typename Element>
+    void store(Vector<Element> value, Element* destination) {
+        alignas(sizeof(Vector<Element>)) Element aligned[Vector<Element>::SIMDNumElements];
+        value.copyToRawArray(aligned);
+        std::memcpy(destination, aligned, sizeof(aligned));
+    }
+#endif
+
+    template<typename T>
+    T sinApprox(T x) {
+        x = max(min(x, splat<T>(kMaxSinInput)), splat<T>(-kMaxSinInput));
+
+        // Nearest multiple of 2 pi, subtracted in two parts to keep the low bits of the reduced argument
+        const T k = truncate(x * kInvTwoPi + (kRoundOffset + 0.5f)) - kRoundOffset;
+        T r       = x - k * kTwoPiHigh - k * kTwoPiLow;
+
+        // Fold [-pi, pi] onto [-pi/2, pi/2] using sin(x) = sin(pi - x)
+        r = min(r, splat<T>(kPi) - r);
+        r = max(r, splat<T>(-kPi) - r);
+
+        const T r2 = r * r;
+        return r * ((((((r2 * kSin11 + kSin9) * r2 + kSin7) * r2 + kSin5) * r2 + kSin3) * r2) + 1.0f);
+    }
+
+    template<typename T>
+    T tanhApprox(T x) {
+        const T h  = max(min(x, splat<T>(kMaxTanhInput)), splat<T>(-kMaxTanhInput)) * 0.5f;
+        const T h2 = h * h;
+
+        // tanh(h) = n / d, then tanh(2h) = 2 tanh(h) / (1 + tanh(h)^2) = 2nd / (d^2 + n^2)
+        const T n = h * (((h2 + 378.0f) * h2 + 17325.0f) * h2 + 135135.0f);
+        const T d = ((h2 * 28.0f + 3150.0f) * h2 + 62370.0f) * h2 + 135135.0f;
+        return divide(n * d * 2.0f, d * d + n * n);
+    }
+
+    template<typename T>
+    T shapeApprox(T input, T drive) {
+        const T harmonic = sinApprox(input * drive * 2.0f);
+        return tanhApprox((input + harmonic * SaturationKernel::kHarmonicAmount) * drive);
+    }
+
+    // Drive either comes as one value per sample or as a single settled value for the whole span
+    template<typename SampleType>
+    SampleType driveAt(const SampleType* drive, int index) {
+        return drive[index];
+    }
+
+    template<typename SampleType>
+    SampleType driveAt(SampleType drive, int) {
+        return drive;
+    }
+
+#if JUCE_USE_SIMD
+    template<typename SampleType>
+    Vector<SampleType> loadDrive(const SampleType* drive, int index) {
+        return load(drive + index);
+    }
+
+    template<typename SampleType>
+    Vector<SampleType> loadDrive(SampleType drive, int) {
+        return Vector<SampleType>::expand(drive);
+    }
+#endif
+
+    template<typename SampleType, typename DriveSource>
+    void processSpan(SampleType* data, DriveSource drive, int numSamples, SaturationKernel::Mode mode) {
+        if (mode == SaturationKernel::Mode::scalar) {
+            for (int i = 0; i < numSamples; ++i) {
+                data[i] = SaturationKernel::saturate(data[i], driveAt(drive, i));
+            }
+            return;
+        }
+
+        int i = 0;
+
+#if JUCE_USE_SIMD
+        constexpr auto laneCount = static_cast<int>(Vector<SampleType>::SIMDNumElements);
+
+        for (; i + laneCount <= numSamples; i += laneCount) {
+            store(shapeApprox(load(data + i), loadDrive(drive, i)), data + i);
+        }
+#endif
+
+        for (; i < numSamples; ++i) {
+            data[i] = shapeApprox(data[i], driveAt(drive, i));
+        }
+    }
+
+    // Encodes one pair (of samples or of registers), shapes mid and side and decodes back in place
+    template<typename T, typename Shape>
+    void shapeMidSide(T& left, T& right, T midDrive, T sideDrive, Shape shape) {
+        const T shapedMid  = shape((left + right) * 0.5f, midDrive);
+        const T shapedSide = shape((left - right) * 0.5f, sideDrive);
+        left               = shapedMid + shapedSide;
+        right              = shapedMid - shapedSide;
+    }
+
+    template<typename SampleType, typename DriveSource>
+    void processMidSideSpan(SampleType* left,
+                            SampleType* right,
+                            DriveSource midDrive,
+                            DriveSource sideDrive,
+                            int numSamples,
+                            SaturationKernel::Mode mode) {
+        const auto exact  = [](SampleType input, SampleType drive) { return SaturationKernel::saturate(input, drive); };
+        const auto approx = [](auto input, auto drive) { return shapeApprox(input, drive); };
+
+        if (mode == SaturationKernel::Mode::scalar) {
+            for (int i = 0; i < numSamples; ++i) {
+                shapeMidSide(left[i], right[i], driveAt(midDrive, i), driveAt(sideDrive, i), exact);
+            }
+            return;
+        }
+
+        int i = 0;
+
+#if JUCE_USE_SIMD
+        constexpr auto laneCount = static_cast<int>(Vector<SampleType>::SIMDNumElements);
+
+        for (; i + laneCount <= numSamples; i += laneCount) {
+            auto leftLanes  = load(left + i);
+            auto rightLanes = load(right + i);
+            shapeMidSide(leftLanes, rightLanes, loadDrive(midDrive, i), loadDrive(sideDrive, i), approx);
+            store(leftLanes, left + i);
+            store(rightLanes, right + i);
+        }
+#endif
+
+        for (; i < numSamples; ++i) {
+            shapeMidSide(left[i], right[i], driveAt(midDrive, i), driveAt(sideDrive, i), approx);
+        }
+    }
+
+    // Below this the loudest channel is treated as this level, where the curve is still a straight line
+    constexpr float kMinLinkedPeak = 1.0e-6f;
+
+    template<typename SampleType, typename DriveSource>
+    void processLinkedSpan(SampleType* const* channels,
+                           int numChannels,
+                           DriveSource drive,
+                           int numSamples,
+                           SaturationKernel::Mode mode) {
+        if (mode == SaturationKernel::Mode::scalar) {
+            for (int i = 0; i < numSamples; ++i) {
+                SampleType peak = kMinLinkedPeak;
+                for (int channel = 0; channel < numChannels; ++channel) {
+                    peak = juce::jmax(peak, std::abs(channels[channel][i]));
+                }
+
+                const auto gain = SaturationKernel::saturate(peak, driveAt(drive, i)) / peak;
+                for (int channel = 0; channel < numChannels; ++channel) channels[channel][i] *= gain;
+            }
+            return;
+        }
+
+        int i = 0;
+
+#if JUCE_USE_SIMD
+        using Lanes              = Vector<SampleType>;
+        constexpr auto laneCount = static_cast<int>(Lanes::SIMDNumElements);
+
+        for (; i + laneCount <= numSamples; i += laneCount) {
+            auto peak = splat<Lanes>(kMinLinkedPeak);
+            for (int channel = 0; channel < numChannels; ++channel) {
+                const auto lanes = load(channels[channel] + i);
+                peak             = max(peak, max(lanes, splat<Lanes>(0.0f) - lanes));
+            }
+
+            const auto gain = divide(shapeApprox(peak, loadDrive(drive, i)), peak);
+            for (int channel = 0; channel < numChannels; ++channel) {
+                store(load(channels[channel] + i) * gain, channels[channel] + i);
+            }
+        }
+#endif
+
+        for (; i < numSamples; ++i) {
+            SampleType peak = kMinLinkedPeak;
+            for (int channel = 0; channel < numChannels; ++channel) {
+                peak = juce::jmax(peak, std::abs(channels[channel][i]));
+            }
+
+            const auto gain = shapeApprox(peak, driveAt(drive, i)) / peak;
+            for (int channel = 0; channel < numChannels; ++channel) channels[channel][i] *= gain;
+        }
+    }
+}  // namespace
+
+float SaturationKernel::saturate(float input, float drive) {
+    float fundamental = input;
+    float harmonic    = std::sin(input * drive * 2.0f);
+    return std::tanh((fundamental + harmonic * kHarmonicAmount) * drive);
+}
+
+double SaturationKernel::saturate(double input, double drive) {
+    double fundamental = input;
+    double harmonic    = std::sin(input * drive * 2.0);
+    return std::tanh((fundamental + harmonic * kHarmonicAmount) * drive);
+}
+
+float SaturationKernel::getSmallSignalGain(float drive) {
+    return (1.0f + 2.0f * kHarmonicAmount * drive) * drive;
+}
+
+float SaturationKernel::saturateApprox(float input, float drive) {
+    return shapeApprox(input, drive);
+}
+
+void SaturationKernel::process(float* data, const float* drive, int numSamples, Mode mode) {
+    processSpan(data, drive, numSamples, mode);
+}
+
+void SaturationKernel::process(float* data, float drive, int numSamples, Mode mode) {
+    processSpan(data, drive, numSamples, mode);
+}
+
+void SaturationKernel::process(double* data, const double* drive, int numSamples, Mode mode) {
+    processSpan(data, drive, numSamples, mode);
+}
+
+void SaturationKernel::process(double* data, double drive, int numSamples, Mode mode) {
+    processSpan(data, drive, numSamples, mode);
+}
+
+void SaturationKernel::processMidSide(float* left,
+                                      float* right,
+                                      const float* midDrive,
+                                      const float* sideDrive,
+                                      int numSamples,
+                                      Mode mode) {
+    processMidSideSpan(left, right, midDrive, sideDrive, numSamples, mode);
+}
+
+void SaturationKernel::processMidSide(float* left,
+                                      float* right,
+                                      float midDrive,
+                                      float sideDrive,
+                                      int numSamples,
+                                      Mode mode) {
+    processMidSideSpan(left, right, midDrive, sideDrive, numSamples, mode);
+}
+
+void SaturationKernel::processMidSide(double* left,
+                                      double* right,
+                                      const double* midDrive,
+                                      const double* sideDrive,
+                                      int numSamples,
+                                      Mode mode) {
+    processMidSideSpan(left, right, midDrive, sideDrive, numSamples, mode);
+}
+
+void SaturationKernel::processMidSide(double* left,
+                                      double* right,
+                                      double midDrive,
+                                      double sideDrive,
+                                      int numSamples,
+                                      Mode mode) {
+    processMidSideSpan(left, right, midDrive, sideDrive, numSamples, mode);
+}
+
+void SaturationKernel::processLinked(float* const* channels,
+                                     int numChannels,
+                                     const float* drive,
+                                     int numSamples,
+                                     Mode mode) {
+    processLinkedSpan(channels, numChannels, drive, numSamples, mode);
+}
+
+void SaturationKernel::processLinked(float* const* channels, int numChannels, float drive, int numSamples, Mode mode) {
+    processLinkedSpan(channels, numChannels, drive, numSamples, mode);
+}
+
+void SaturationKernel::processLinked(double* const* channels,
+                                     int numChannels,
+                                     const double* drive,
+                                     int numSamples,
+                                     Mode mode) {
+    processLinkedSpan(channels, numChannels, drive, numSamples, mode);
+}
+
+void SaturationKernel::processLinked(double* const* channels,
+                                     int numChannels,
+                                     double drive,
+                                     int numSamples,
+                                     Mode mode) {
+    processLinkedSpan(channels, numChannels, drive, numSamples, mode);
+}
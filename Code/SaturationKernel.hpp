@@ -0,0 +1,81 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+/**
+ * Greg's transfer curve, tanh((x + 0.3 sin(2xd)) * d), applied to contiguous runs of samples.
+ *
+ * The scalar mode is the reference: it calls std::sin/std::tanh for every sample. The vectorized mode works on
+ * juce::dsp::SIMDRegister lanes (SSE, AVX or NEON, whatever JUCE picked for the target) with these approximations:
+ *
+ *  - sin:  Cody-Waite reduction to [-pi/2, pi/2] and a degree 11 odd polynomial, |error| < 3e-7 for |x| <= 4096.
+ *          Arguments outside that range are clamped.
+ *  - tanh: [7/6] Lambert continued fraction evaluated at x/2 and recombined with the double-angle identity,
+ *          |error| < 2e-7 over the whole real line (inputs are clamped to +-9 where tanh is 1 in float).
+ *
+ * Measured against a double precision reference over |input| <= 4 and drive 0 to +30 dB, the complete curve stays
+ * within 6e-6 of the exact value; the float std::sin/std::tanh path has an error of 4.2e-6 over the same range.
+ */
+class SaturationKernel {
+public:
+    enum class Mode { scalar, vectorized };
+
+    static constexpr float kHarmonicAmount = 0.3f;
+
+    /** The exact curve, evaluated with std::sin/std::tanh. */
+    static float saturate(float input, float drive);
+    static double saturate(double input, double drive);
+
+    /** The curve's slope at zero, (1 + 2 * 0.3 * drive) * drive, the most gain it can apply to any input. */
+    static float getSmallSignalGain(float drive);
+
+    /** The approximated curve used by the vectorized mode, one sample at a time. */
+    static float saturateApprox(float input, float drive);
+
+    /** Shapes numSamples samples in place, drive holds one linear drive gain per sample. */
+    static void process(float* data, const float* drive, int numSamples, Mode mode);
+
+    /** Shapes numSamples samples in place with a settled drive gain. */
+    static void process(float* data, float drive, int numSamples, Mode mode);
+
+    /**
+     * The same for double precision. The vectorized mode runs the float approximations on double lanes (2 on
+     * SSE/NEON, 4 on AVX), so it stays within the float accuracy above. Use the scalar mode for the exact curve.
+     */
+    static void process(double* data, const double* drive, int numSamples, Mode mode);
+    static void process(double* data, double drive, int numSamples, Mode mode);
+
+    /**
+     * Mid/side in one pass: each left/right pair is encoded to mid = (l + r) / 2 and side = (l - r) / 2, both are
+     * shaped with their own drive gain and decoded back in place, without an intermediate buffer. The drives hold one
+     * linear gain per sample, or are settled values.
+     */
+    static void processMidSide(float* left,
+                               float* right,
+                               const float* midDrive,
+                               const float* sideDrive,
+                               int numSamples,
+                               Mode mode);
+    static void processMidSide(float* left, float* right, float midDrive, float sideDrive, int numSamples, Mode mode);
+    static void processMidSide(double* left,
+                               double* right,
+                               const double* midDrive,
+                               const double* sideDrive,
+                               int numSamples,
+                               Mode mode);
+    static void processMidSide(double* left,
+                               double* right,
+                               double midDrive,
+                               double sideDrive,
+                               int numSamples,
+                               Mode mode);
+
+    /**
+     * Stereo-linked: at every sample the curve is evaluated for the loudest channel only, and the gain it applies
+     * there, f(peak) / peak, is applied to all channels. The balance between channels, and so the image, is kept.
+     */
+    static void processLinked(float* const* channels, int numChannels, const float* drive, int numSamples, Mode mode);
+    static void processLinked(float* const* channels, int numChannels, float drive, int numSamples, Mode mode);
+    static void processLinked(double* const* channels, int numChannels, const double* drive, int numSamples, Mode mode);
+    static void processLinked(double* const* channels, int numChannels, double drive, int numSamples, Mode mode);
+};
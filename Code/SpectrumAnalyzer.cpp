@@ -0,0 +1,99 @@
+#include "SpectrumAnalyzer.hpp"
+
+SpectrumAnalyzer::SpectrumAnalyzer() {
+    prepare(mSampleRate);
+}
+
+void SpectrumAnalyzer::prepare(double sampleRate) {
+    mSampleRate    = sampleRate;
+    mWritePosition = 0;
+    mNewSamples    = 0;
+    std::fill(mHistory.begin(), mHistory.end(), 0.0f);
+    mMeasured.fill(kMinDb);
+    mLevels.fill(kMinDb);
+
+    const auto binsPerHz = static_cast<float>(kFftSize / sampleRate);
+    const auto frequency = [](float point) {
+        return kMinFrequency * std::pow(kMaxFrequency / kMinFrequency, point / static_cast<float>(kNumPoints - 1));
+    };
+
+    for (size_t point = 0; point < mEdgeBins.size(); ++point) {
+        mEdgeBins[point] = frequency(static_cast<float>(point) - 0.5f) * binsPerHz;
+    }
+    for (size_t point = 0; point < mCentreBins.size(); ++point) {
+        mCentreBins[point] = frequency(static_cast<float>(point)) * binsPerHz;
+    }
+}
+
+void SpectrumAnalyzer::push(const float* samples, int numSamples) {
+    mNewSamples = juce::jmin(kFftSize, mNewSamples + numSamples);
+
+    // Only the newest kFftSize samples can matter
+    const auto skipped = juce::jmax(0, numSamples - kFftSize);
+    samples += skipped;
+    numSamples -= skipped;
+
+    while (numSamples > 0) {
+        const auto count = juce::jmin(numSamples, kFftSize - mWritePosition);
+        std::copy_n(samples, count, mHistory.data() + mWritePosition);
+
+        mWritePosition = (mWritePosition + count) % kFftSize;
+        samples += count;
+        numSamples -= count;
+    }
+}
+
+bool SpectrumAnalyzer::update(double elapsedSeconds) {
+    if (mNewSamples >= kHopSize) {
+        mNewSamples = 0;
+        analyse();
+    }
+
+    const auto fall = static_cast<float>(kFallDbPerSecond * elapsedSeconds);
+    bool changed    = false;
+
+    for (size_t point = 0; point < mLevels.size(); ++point) {
+        const auto level = juce::jmax(mMeasured[point], mLevels[point] - fall);
+        changed          = changed || level != mLevels[point];
+        mLevels[point]   = level;
+    }
+
+    return changed;
+}
+
+void SpectrumAnalyzer::analyse() {
+    // Oldest sample first, mWritePosition is where the next one would go
+    const auto tail = kFftSize - mWritePosition;
+    std::copy_n(mHistory.data() + mWritePosition, tail, mFftData.data());
+    std::copy_n(mHistory.data(), mWritePosition, mFftData.data() + tail);
+
+    // The window is normalised to a mean of 1, so a full scale sine peaks at kFftSize / 2
+    mWindow.multiplyWithWindowingTable(mFftData.data(), kFftSize);
+    mFft.performFrequencyOnlyForwardTransform(mFftData.data(), true);
+
+    constexpr auto kNyquistBin = kFftSize / 2;
+    const auto* magnitudes     = mFftData.data();
+    const auto magnitudeToDb   = [](float magnitude) {
+        return juce::Decibels::gainToDecibels(magnitude * (2.0f / kFftSize), kMinDb);
+    };
+
+    for (size_t point = 0; point < mMeasured.size(); ++point) {
+        const auto firstBin = static_cast<int>(std::ceil(mEdgeBins[point]));
+        const auto lastBin  = juce::jmin(kNyquistBin, static_cast<int>(std::floor(mEdgeBins[point + 1])));
+        const auto centre   = mCentreBins[point];
+
+        if (centre >= static_cast<float>(kNyquistBin)) {
+            mMeasured[point] = kMinDb;
+        } else if (firstBin <= lastBin) {
+            // Wider than a bin, show the strongest component in range
+            float magnitude = 0.0f;
+            for (int bin = firstBin; bin <= lastBin; ++bin) magnitude = juce::jmax(magnitude, magnitudes[bin]);
+            mMeasured[point] = magnitudeToDb(magnitude);
+        } else {
+            // Narrower than a bin, interpolate between the two around it
+            const auto lower    = static_cast<int>(centre);
+            const auto fraction = centre - static_cast<float>(lower);
+            mMeasured[point]    = magnitudeToDb(juce::jmap(fraction, magnitudes[lower], magnitudes[lower + 1]));
+        }
+    }
+}
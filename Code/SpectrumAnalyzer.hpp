@@ -0,0 +1,66 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+/**
+ * Turns the analyzer samples of a MeterFeed into a spectrum for display, on the consumer's thread.
+ *
+ * push() keeps the newest kFftSize samples. update() runs at most one Hann-windowed FFT over them, only once at least
+ * kHopSize new samples have arrived, so calling it from a frame timer caps the FFT rate at the frame rate however
+ * much audio came in. The magnitudes are reduced to kNumPoints log-spaced points from kMinFrequency to kMaxFrequency
+ * (the loudest bin within each point's range, interpolated where a point falls between bins), in dB relative to a
+ * full scale sine. Points rise at once and fall at kFallDbPerSecond. Allocates only on construction.
+ */
+class SpectrumAnalyzer {
+public:
+    static constexpr int kFftOrder  = 12;
+    static constexpr int kFftSize   = 1 << kFftOrder;
+    static constexpr int kHopSize   = kFftSize / 4;
+    static constexpr int kNumPoints = 160;
+
+    static constexpr float kMinFrequency    = 20.0f;
+    static constexpr float kMaxFrequency    = 20000.0f;
+    static constexpr float kMinDb           = -96.0f;
+    static constexpr float kFallDbPerSecond = 36.0f;
+
+    SpectrumAnalyzer();
+
+    /** Clears the history and the spectrum. sampleRate is the rate of the pushed samples. */
+    void prepare(double sampleRate);
+
+    void push(const float* samples, int numSamples);
+
+    /** Runs the FFT if enough new samples arrived. Returns true if the spectrum changed since the last call. */
+    bool update(double elapsedSeconds);
+
+    float getLevelDb(int point) const {
+        return mLevels[static_cast<size_t>(point)];
+    }
+
+    /** Where a point sits between kMinFrequency (0) and kMaxFrequency (1) on a log axis. */
+    static float getPosition(int point) {
+        return static_cast<float>(point) / static_cast<float>(kNumPoints - 1);
+    }
+
+private:
+    juce::dsp::FFT mFft {kFftOrder};
+    juce::dsp::WindowingFunction<float> mWindow {kFftSize, juce::dsp::WindowingFunction<float>::hann, true};
+
+    double mSampleRate = 48000.0;
+
+    // The newest kFftSize samples as a ring, and how many arrived since the last FFT
+    std::vector<float> mHistory = std::vector<float>(kFftSize);
+    int mWritePosition          = 0;
+    int mNewSamples             = 0;
+
+    std::vector<float> mFftData = std::vector<float>(2 * kFftSize);
+
+    std::array<float, kNumPoints> mMeasured;  // The latest FFT
+    std::array<float, kNumPoints> mLevels;    // What is shown, falling towards mMeasured
+
+    // Each point's range of bins, from the geometric midpoints to its neighbours, and its centre
+    std::array<float, kNumPoints + 1> mEdgeBins {};
+    std::array<float, kNumPoints> mCentreBins {};
+
+    void analyse();
+};
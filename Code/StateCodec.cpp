@@ -0,0 +1,72 @@
+#include "StateCodec.hpp"
+
+namespace {
+    // UTF-8 with a Length sized byte count in front, cut short if it doesn't fit
+    template<typename Length>
+    void writeString(juce::MemoryOutputStream& stream, const juce::String& text) {
+        constexpr auto maxBytes = static_cast<size_t>(std::numeric_limits<Length>::max());
+
+        const auto utf8     = text.toUTF8();
+        const auto numBytes = juce::jmin(utf8.sizeInBytes() - 1, maxBytes);
+
+        if constexpr (sizeof(Length) == 1) stream.writeByte(static_cast<char>(numBytes));
+        else stream.writeShort(static_cast<short>(numBytes));
+
+        stream.write(utf8.getAddress(), numBytes);
+    }
+
+    bool readString(juce::MemoryInputStream& stream, size_t numBytes, juce::String& text) {
+        if (static_cast<juce::int64>(numBytes) > stream.getNumBytesRemaining()) return false;
+
+        const auto* start = static_cast<const char*>(stream.getData()) + stream.getPosition();
+        text              = juce::String::fromUTF8(start, static_cast<int>(numBytes));
+        stream.skipNextBytes(static_cast<juce::int64>(numBytes));
+        return true;
+    }
+}  // namespace
+
+void StateCodec::write(const State& state, juce::MemoryBlock& destination) {
+    juce::MemoryOutputStream stream(destination, false);
+
+    stream.writeInt(static_cast<int>(kMagic));
+    stream.writeShort(static_cast<short>(kVersion));
+    stream.writeShort(static_cast<short>(state.parameters.size()));
+    writeString<juce::uint16>(stream, state.presetName);
+
+    for (const auto& [id, value] : state.parameters) {
+        writeString<juce::uint8>(stream, id);
+        stream.writeFloat(value);
+    }
+}
+
+bool StateCodec::read(const void* data, size_t sizeInBytes, State& state) {
+    if (!isBinaryState(data, sizeInBytes)) return false;
+
+    juce::MemoryInputStream stream(data, sizeInBytes, false);
+    stream.skipNextBytes(sizeof(kMagic) + sizeof(kVersion));
+
+    const auto numParameters = static_cast<juce::uint16>(stream.readShort());
+    const auto nameBytes     = static_cast<juce::uint16>(stream.readShort());
+    if (!readString(stream, nameBytes, state.presetName)) return false;
+
+    state.parameters.clear();
+    state.parameters.reserve(numParameters);
+
+    for (int i = 0; i < numParameters; ++i) {
+        juce::String id;
+        const auto idBytes = static_cast<juce::uint8>(stream.readByte());
+        if (!readString(stream, idBytes, id) || stream.getNumBytesRemaining() < 4) return false;
+
+        state.parameters.emplace_back(id, stream.readFloat());
+    }
+
+    return true;
+}
+
+bool StateCodec::isBinaryState(const void* data, size_t sizeInBytes) {
+    constexpr size_t headerSize = sizeof(kMagic) + sizeof(kVersion) + 2 * sizeof(juce::uint16);
+    if (data == nullptr || sizeInBytes < headerSize) return false;
+
+    const auto version = juce::ByteOrder::littleEndianShort(static_cast<const char*>(data) + sizeof(kMagic));
+    return juce::ByteOrder::littleEndianInt(data) == kMagic && version >= 1;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+/**
+ * Greg's compact binary plugin state.
+ *
+ * Layout, all little endian: magic, version (uint16), parameter count (uint16), preset name (uint16 byte length plus
+ * UTF-8), then per parameter its ID (uint8 byte length plus UTF-8) and value (float32, in the parameter's own
+ * units). Later versions may only append to this, so any version can be read as far as this layout goes.
+ *
+ * States saved before this format existed are XML wrapped by copyXmlToBinary; isBinaryState() tells them apart.
+ */
+class StateCodec {
+public:
+    static constexpr juce::uint32 kMagic   = 0x47455247;  // "GREG"
+    static constexpr juce::uint16 kVersion = 1;
+
+    struct State {
+        juce::String presetName;
+        std::vector<std::pair<juce::String, float>> parameters;  // ID and value
+    };
+
+    static void write(const State& state, juce::MemoryBlock& destination);
+
+    /** Returns false if the data isn't a binary state or is truncated. */
+    static bool read(const void* data, size_t sizeInBytes, State& state);
+
+    static bool isBinaryState(const void* data, size_t sizeInBytes);
+};
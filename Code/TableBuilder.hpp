@@ -0,0 +1,33 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+/**
+ * Runs a shared table's build function on a background thread, for tables switched on during playback.
+ *
+ * Meant to live as a function-local static next to the table, so unloading the binary waits for a build that is
+ * still running. start() does nothing while a build runs or once isBuilt() returns true.
+ */
+class TableBuilder : private juce::Thread {
+public:
+    TableBuilder(const juce::String& threadName, void (*build)(), bool (*isBuilt)())
+        : juce::Thread(threadName), mBuild(build), mIsBuilt(isBuilt) {}
+
+    ~TableBuilder() override {
+        stopThread(-1);
+    }
+
+    void start() {
+        if (!mIsBuilt()) startThread();  // A no-op while the thread is already running
+    }
+
+private:
+    void (*mBuild)();
+    bool (*mIsBuilt)();
+
+    void run() override {
+        mBuild();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE(TableBuilder)
+};
@@ -0,0 +1,115 @@
+#include "Telemetry.hpp"
+
+const char* Telemetry::getStageName(Stage stage) {
+    switch (stage) {
+        case Stage::upsample:
+            return "upsample";
+        case Stage::tone:
+            return "tone";
+        case Stage::shape:
+            return "shape";
+        case Stage::downsample:
+            return "downsample";
+        case Stage::mix:
+            return "mix";
+    }
+
+    return "";
+}
+
+void Telemetry::prepare(double sampleRate) {
+    mSampleRate = sampleRate;
+    mPeakLoad   = 0.0f;
+}
+
+template<typename SampleType>
+bool Telemetry::beginBlock(const juce::AudioBuffer<SampleType>& input) {
+    mBlockActive = isEnabled();
+    if (!mBlockActive) return false;
+
+    mStageTicks.fill(0);
+    mInputHasDenormal = scan(input).hasDenormal;
+    mBlockStartTicks  = juce::Time::getHighResolutionTicks();
+    return true;
+}
+
+template<typename SampleType>
+void Telemetry::endBlock(const juce::AudioBuffer<SampleType>& output) {
+    if (!mBlockActive) return;
+    mBlockActive = false;
+
+    const auto elapsedMicros  = static_cast<double>(juce::Time::getHighResolutionTicks() - mBlockStartTicks)
+                             * mTicksToMicros;
+    const auto numSamples     = output.getNumSamples();
+    const auto deadlineMicros = numSamples * 1.0e6 / mSampleRate;
+    const auto flags          = scan(output);
+
+    BlockRecord record;
+    record.blockIndex   = mBlockCount.load(std::memory_order_relaxed);
+    record.numSamples   = numSamples;
+    record.load         = deadlineMicros > 0.0 ? static_cast<float>(elapsedMicros / deadlineMicros) : 0.0f;
+    record.hasNonFinite = flags.hasNonFinite;
+    record.hasDenormal  = flags.hasDenormal || mInputHasDenormal;
+
+    for (size_t stage = 0; stage < mStageTicks.size(); ++stage) {
+        record.stageMicros[stage] = static_cast<float>(static_cast<double>(mStageTicks[stage]) * mTicksToMicros);
+        mStageMicros[stage].store(record.stageMicros[stage], std::memory_order_relaxed);
+    }
+
+    // This thread is the only writer of the peak, a reader asks for a reset through the flag
+    const auto previousPeak = mPeakResetRequested.exchange(false) ? 0.0f : mPeakLoad.load(std::memory_order_relaxed);
+    mPeakLoad.store(juce::jmax(previousPeak, record.load), std::memory_order_relaxed);
+    mLoad.store(record.load, std::memory_order_relaxed);
+
+    if (record.hasNonFinite) mNonFiniteBlockCount.fetch_add(1, std::memory_order_relaxed);
+    if (record.hasDenormal) mDenormalBlockCount.fetch_add(1, std::memory_order_relaxed);
+    mBlockCount.fetch_add(1, std::memory_order_relaxed);
+
+    const auto scope = mFifo.write(1);
+    if (scope.blockSize1 > 0) {
+        mRecords[static_cast<size_t>(scope.startIndex1)] = record;
+    } else {
+        mDroppedRecordCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+int Telemetry::readRecords(BlockRecord* destination, int maxRecords) {
+    const auto scope = mFifo.read(maxRecords);
+    int numRead      = 0;
+
+    scope.forEach([&](int index) { destination[numRead++] = mRecords[static_cast<size_t>(index)]; });
+    return numRead;
+}
+
+template<typename SampleType>
+Telemetry::SignalFlags Telemetry::scan(const juce::AudioBuffer<SampleType>& buffer) {
+    constexpr bool isDouble = std::is_same_v<SampleType, double>;
+    using Bits              = std::conditional_t<isDouble, juce::uint64, juce::uint32>;
+
+    constexpr Bits exponentMask = isDouble ? Bits(0x7ff0000000000000) : Bits(0x7f800000);
+    constexpr Bits mantissaMask = isDouble ? Bits(0x000fffffffffffff) : Bits(0x007fffff);
+
+    // Accumulate the exponent/mantissa tests branch free, so the loop vectorises
+    Bits sawNonFinite = 0;
+    Bits sawDenormal  = 0;
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+        const auto* data = buffer.getReadPointer(channel);
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i) {
+            Bits bits;
+            std::memcpy(&bits, data + i, sizeof(bits));
+
+            const auto exponent = bits & exponentMask;
+            sawNonFinite |= static_cast<Bits>(exponent == exponentMask);
+            sawDenormal |= static_cast<Bits>(exponent == 0 && (bits & mantissaMask) != 0);
+        }
+    }
+
+    return {sawNonFinite != 0, sawDenormal != 0};
+}
+
+template bool Telemetry::beginBlock(const juce::AudioBuffer<float>&);
+template bool Telemetry::beginBlock(const juce::AudioBuffer<double>&);
+template void Telemetry::endBlock(const juce::AudioBuffer<float>&);
+template void Telemetry::endBlock(const juce::AudioBuffer<double>&);
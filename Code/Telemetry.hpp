@@ -0,0 +1,147 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+/**
+ * Per-block DSP timing and signal health, gathered on the audio thread without locks or allocation.
+ *
+ * processBlock() brackets its work with beginBlock()/endBlock() and each stage with a ScopedStage. While telemetry is
+ * disabled beginBlock() returns false and every ScopedStage reduces to one branch. The latest block and the running
+ * totals are published through atomics for the editor. Every block is also pushed into a fixed size wait-free SPSC
+ * ring, which exactly one consumer (see TelemetryLogger) drains with readRecords().
+ */
+class Telemetry {
+public:
+    enum class Stage { upsample, tone, shape, downsample, mix };
+
+    static constexpr int kNumStages = 5;
+    static constexpr int kRingSize  = 1024;
+
+    struct BlockRecord {
+        juce::uint64 blockIndex = 0;
+        int numSamples          = 0;
+        float load              = 0.0f;  // Processing time relative to the block's duration
+        std::array<float, kNumStages> stageMicros {};
+        bool hasNonFinite = false;  // NaN or infinity in the output
+        bool hasDenormal  = false;  // Denormals in the input or output
+    };
+
+    static const char* getStageName(Stage stage);
+
+    /** Can be called from any thread. Takes effect at the start of the next block. */
+    void setEnabled(bool enabled) {
+        mEnabled = enabled;
+    }
+
+    bool isEnabled() const {
+        return mEnabled.load(std::memory_order_relaxed);
+    }
+
+    void prepare(double sampleRate);
+
+    // Audio thread
+
+    /**
+     * Starts timing a block. Returns false, and records nothing for this block, while telemetry is disabled. Both
+     * calls take float or double buffers.
+     */
+    template<typename SampleType>
+    bool beginBlock(const juce::AudioBuffer<SampleType>& input);
+
+    template<typename SampleType>
+    void endBlock(const juce::AudioBuffer<SampleType>& output);
+
+    /** Adds the time until it goes out of scope to a stage of the current block. Stages may be entered repeatedly. */
+    class ScopedStage {
+    public:
+        ScopedStage(Telemetry& telemetry, Stage stage)
+            : mTelemetry(telemetry), mStage(stage),
+              mStartTicks(telemetry.mBlockActive ? juce::Time::getHighResolutionTicks() : 0) {}
+
+        ~ScopedStage() {
+            if (mTelemetry.mBlockActive) {
+                mTelemetry.mStageTicks[static_cast<size_t>(mStage)] +=
+                  juce::Time::getHighResolutionTicks() - mStartTicks;
+            }
+        }
+
+    private:
+        Telemetry& mTelemetry;
+        Stage mStage;
+        juce::int64 mStartTicks;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedStage)
+    };
+
+    // Any thread
+
+    float getLoad() const {
+        return mLoad.load(std::memory_order_relaxed);
+    }
+
+    float getPeakLoad() const {
+        return mPeakLoad.load(std::memory_order_relaxed);
+    }
+
+    /** Asks the audio thread to restart the peak from its next block. */
+    void resetPeakLoad() {
+        mPeakResetRequested = true;
+    }
+
+    float getStageMicros(Stage stage) const {
+        return mStageMicros[static_cast<size_t>(stage)].load(std::memory_order_relaxed);
+    }
+
+    juce::uint64 getBlockCount() const {
+        return mBlockCount.load(std::memory_order_relaxed);
+    }
+
+    juce::uint64 getNonFiniteBlockCount() const {
+        return mNonFiniteBlockCount.load(std::memory_order_relaxed);
+    }
+
+    juce::uint64 getDenormalBlockCount() const {
+        return mDenormalBlockCount.load(std::memory_order_relaxed);
+    }
+
+    /** Blocks that found the ring full because the consumer fell behind. */
+    juce::uint64 getDroppedRecordCount() const {
+        return mDroppedRecordCount.load(std::memory_order_relaxed);
+    }
+
+    /** Copies up to maxRecords of the oldest queued blocks into destination. Single consumer only. */
+    int readRecords(BlockRecord* destination, int maxRecords);
+
+private:
+    struct SignalFlags {
+        bool hasNonFinite = false;
+        bool hasDenormal  = false;
+    };
+
+    // Inspects the bit patterns, so it still sees denormals while ScopedNoDenormals makes arithmetic ignore them
+    template<typename SampleType>
+    static SignalFlags scan(const juce::AudioBuffer<SampleType>& buffer);
+
+    std::atomic<bool> mEnabled {false};
+    double mSampleRate    = 44100.0;
+    double mTicksToMicros = 1.0e6 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+
+    // Audio thread only
+    bool mBlockActive            = false;
+    bool mInputHasDenormal       = false;
+    juce::int64 mBlockStartTicks = 0;
+    std::array<juce::int64, kNumStages> mStageTicks {};
+
+    // Published for readers
+    std::atomic<float> mLoad {0.0f};
+    std::atomic<float> mPeakLoad {0.0f};
+    std::atomic<bool> mPeakResetRequested {false};
+    std::array<std::atomic<float>, kNumStages> mStageMicros {};
+    std::atomic<juce::uint64> mBlockCount {0};
+    std::atomic<juce::uint64> mNonFiniteBlockCount {0};
+    std::atomic<juce::uint64> mDenormalBlockCount {0};
+    std::atomic<juce::uint64> mDroppedRecordCount {0};
+
+    juce::AbstractFifo mFifo {kRingSize};
+    std::array<BlockRecord, kRingSize> mRecords;
+};
@@ -0,0 +1,63 @@
+#include "TelemetryLogger.hpp"
+
+#include <iostream>
+
+TelemetryLogger::TelemetryLogger(Telemetry& telemetry, const juce::File& file)
+    : juce::Thread("Greg telemetry"), mTelemetry(telemetry), mRecords(kRecordsPerRead) {
+    if (file != juce::File()) {
+        mFileStream = std::make_unique<juce::FileOutputStream>(file);
+        if (mFileStream->failedToOpen()) mFileStream.reset();
+    }
+
+    juce::String header("block,samples,load");
+    for (int stage = 0; stage < Telemetry::kNumStages; ++stage) {
+        header << "," << Telemetry::getStageName(static_cast<Telemetry::Stage>(stage)) << "_us";
+    }
+    writeLine(header + ",non_finite,denormal");
+
+    startThread();
+}
+
+TelemetryLogger::~TelemetryLogger() {
+    stopThread(1000);
+    drain();
+
+    const auto dropped = mTelemetry.getDroppedRecordCount();
+    if (dropped > 0) writeLine("# dropped " + juce::String(dropped) + " blocks");
+}
+
+void TelemetryLogger::run() {
+    while (!threadShouldExit()) {
+        drain();
+        wait(kPollIntervalMs);
+    }
+}
+
+void TelemetryLogger::drain() {
+    for (;;) {
+        const auto numRead = mTelemetry.readRecords(mRecords.data(), kRecordsPerRead);
+        if (numRead == 0) return;
+
+        for (int i = 0; i < numRead; ++i) {
+            const auto& record = mRecords[static_cast<size_t>(i)];
+
+            juce::String line;
+            line << juce::String(record.blockIndex) << "," << record.numSamples << ","
+                 << juce::String(record.load, 4);
+            for (const auto micros : record.stageMicros) {
+                line << "," << juce::String(micros, 2);
+            }
+            line << "," << (record.hasNonFinite ? 1 : 0) << "," << (record.hasDenormal ? 1 : 0);
+
+            writeLine(line);
+        }
+    }
+}
+
+void TelemetryLogger::writeLine(const juce::String& line) {
+    if (mFileStream != nullptr) {
+        mFileStream->writeText(line + "\n", false, false, nullptr);
+    } else {
+        std::cout << line << "\n";
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include "Telemetry.hpp"
+
+/**
+ * Background consumer of a Telemetry ring, writing one CSV line per processed block.
+ *
+ * Meant for headless runs (GregBench, CI) where there is no editor to look at. Appends to the given file, or writes
+ * to stdout when none is given, starting with a header line. It must be the only reader of the Telemetry it's
+ * attached to and has to be destroyed before it.
+ */
+class TelemetryLogger : private juce::Thread {
+public:
+    explicit TelemetryLogger(Telemetry& telemetry, const juce::File& file = {});
+    ~TelemetryLogger() override;
+
+private:
+    static constexpr int kPollIntervalMs = 50;
+    static constexpr int kRecordsPerRead = 256;
+
+    void run() override;
+    void drain();
+    void writeLine(const juce::String& line);
+
+    Telemetry& mTelemetry;
+    std::unique_ptr<juce::FileOutputStream> mFileStream;  // nullptr writes to stdout
+    std::vector<Telemetry::BlockRecord> mRecords;
+};
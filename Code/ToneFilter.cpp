@@ -0,0 +1,122 @@
+#include "ToneFilter.hpp"
+
+namespace {
+    constexpr float kMinCutoff = 500.0f;
+    constexpr float kMaxCutoff = 20000.0f;
+
+    // Lanes is either a SIMDRegister or, without SIMD support, a plain float or double
+    template<typename Lanes, typename SampleType>
+    Lanes loadLanes(const SampleType* source) {
+        if constexpr (std::is_same_v<Lanes, SampleType>) return *source;
+        else return Lanes::fromRawArray(source);
+    }
+
+    template<typename Lanes, typename SampleType>
+    void storeLanes(Lanes value, SampleType* destination) {
+        if constexpr (std::is_same_v<Lanes, SampleType>) *destination = value;
+        else value.copyToRawArray(destination);
+    }
+}  // namespace
+
+template<typename SampleType>
+float ToneFilter<SampleType>::toneToCutoff(float tonePercent) {
+    const auto proportion = juce::jlimit(0.0f, 1.0f, tonePercent * 0.01f);
+    return kMinCutoff * std::pow(kMaxCutoff / kMinCutoff, proportion);
+}
+
+template<typename SampleType>
+void ToneFilter<SampleType>::prepare(int numChannels, double sampleRate) {
+    mLaneGroups.resize((static_cast<size_t>(numChannels) + kNumLanes - 1) / kNumLanes);
+    reset();
+
+    mSampleRate = sampleRate;
+    updateCoefficients();
+}
+
+template<typename SampleType>
+void ToneFilter<SampleType>::reset() {
+    for (auto& group : mLaneGroups) {
+        group.ic1eq.fill(0);
+        group.ic2eq.fill(0);
+    }
+}
+
+template<typename SampleType>
+void ToneFilter<SampleType>::setSampleRate(double sampleRate) {
+    if (sampleRate == mSampleRate) return;
+
+    mSampleRate = sampleRate;
+    updateCoefficients();
+}
+
+template<typename SampleType>
+void ToneFilter<SampleType>::setTone(float tonePercent) {
+    if (tonePercent == mTone) return;
+
+    mTone = tonePercent;
+    updateCoefficients();
+}
+
+template<typename SampleType>
+void ToneFilter<SampleType>::updateCoefficients() {
+    // Keep the cutoff clear of Nyquist, relevant when running without oversampling
+    const auto sampleRate = static_cast<SampleType>(mSampleRate);
+    const auto maxCutoff  = static_cast<SampleType>(mSampleRate * 0.45);
+    const auto cutoff     = juce::jmin(static_cast<SampleType>(toneToCutoff(mTone)), maxCutoff);
+    const auto g          = std::tan(juce::MathConstants<SampleType>::pi * cutoff / sampleRate);
+    const auto damping    = juce::MathConstants<SampleType>::sqrt2;  // 1 / Q, Butterworth
+
+    mA1 = SampleType(1) / (SampleType(1) + g * (g + damping));
+    mA2 = g * mA1;
+    mA3 = g * mA2;
+}
+
+template<typename SampleType>
+void ToneFilter<SampleType>::process(juce::dsp::AudioBlock<SampleType>& block) {
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples  = block.getNumSamples();
+
+    jassert((numChannels + kNumLanes - 1) / kNumLanes <= mLaneGroups.size());
+
+    for (size_t group = 0; group < mLaneGroups.size() && group * kNumLanes < numChannels; ++group) {
+        const auto firstChannel = group * kNumLanes;
+        const auto numLanes     = juce::jmin(kNumLanes, numChannels - firstChannel);
+
+        std::array<SampleType*, kNumLanes> channels {};
+        for (size_t lane = 0; lane < numLanes; ++lane) {
+            channels[lane] = block.getChannelPointer(firstChannel + lane);
+        }
+
+        auto& state = mLaneGroups[group];
+        Lanes ic1eq = loadLanes<Lanes>(state.ic1eq.data());
+        Lanes ic2eq = loadLanes<Lanes>(state.ic2eq.data());
+
+        // One frame holds sample i of every channel in the group, unused lanes stay at zero
+        alignas(sizeof(Lanes)) std::array<SampleType, kNumLanes> frame {};
+
+        for (size_t i = 0; i < numSamples; ++i) {
+            for (size_t lane = 0; lane < numLanes; ++lane) {
+                frame[lane] = channels[lane][i];
+            }
+
+            const Lanes v0 = loadLanes<Lanes>(frame.data());
+            const Lanes v3 = v0 - ic2eq;
+            const Lanes v1 = ic1eq * mA1 + v3 * mA2;
+            const Lanes v2 = ic2eq + ic1eq * mA2 + v3 * mA3;
+
+            ic1eq = v1 * SampleType(2) - ic1eq;
+            ic2eq = v2 * SampleType(2) - ic2eq;
+
+            storeLanes(v2, frame.data());
+            for (size_t lane = 0; lane < numLanes; ++lane) {
+                channels[lane][i] = frame[lane];
+            }
+        }
+
+        storeLanes(ic1eq, state.ic1eq.data());
+        storeLanes(ic2eq, state.ic2eq.data());
+    }
+}
+
+template class ToneFilter<float>;
+template class ToneFilter<double>;
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+/**
+ * Greg's tone control, a 12 dB/oct TPT state variable low-pass (Butterworth Q).
+ *
+ * Channels are packed into the lanes of a juce::dsp::SIMDRegister (4 floats on SSE/NEON, 8 on AVX, half as many
+ * doubles), so a stereo block runs both channels through one register. Coefficients are recomputed only when the
+ * tone or sample rate changes. Filtering happens in place, there are no intermediate buffers. Instantiated for float
+ * and double.
+ */
+template<typename SampleType>
+class ToneFilter {
+public:
+    /** Maps the 0-100 % tone parameter onto 500 Hz to 20 kHz, exponentially. */
+    static float toneToCutoff(float tonePercent);
+
+    /** Allocates filter state for numChannels channels. Not realtime safe. */
+    void prepare(int numChannels, double sampleRate);
+    void reset();
+
+    void setSampleRate(double sampleRate);
+    void setTone(float tonePercent);
+
+    void process(juce::dsp::AudioBlock<SampleType>& block);
+
+private:
+#if JUCE_USE_SIMD
+    using Lanes = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr size_t kNumLanes = Lanes::SIMDNumElements;
+#else
+    using Lanes                       = SampleType;
+    static constexpr size_t kNumLanes = 1;
+#endif
+
+    struct LaneGroup {
+        alignas(sizeof(Lanes)) std::array<SampleType, kNumLanes> ic1eq {};
+        alignas(sizeof(Lanes)) std::array<SampleType, kNumLanes> ic2eq {};
+    };
+
+    void updateCoefficients();
+
+    std::vector<LaneGroup> mLaneGroups;
+
+    double mSampleRate = 44100.0;
+    float mTone        = -1.0f;
+
+    SampleType mA1 = 1;
+    SampleType mA2 = 0;
+    SampleType mA3 = 0;
+};
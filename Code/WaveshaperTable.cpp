@@ -0,0 +1,186 @@
+#include "WaveshaperTable.hpp"
+#include "SaturationKernel.hpp"
+#include "TableBuilder.hpp"
+
+namespace {
+    double analyticCurve(double input, double drive) {
+        const double harmonic = std::sin(input * drive * 2.0);
+        return std::tanh((input + harmonic * SaturationKernel::kHarmonicAmount) * drive);
+    }
+
+    double sliceDrive(int index) {
+        return std::pow(10.0, index * WaveshaperTable::kDriveStepDb / 20.0);
+    }
+
+    using Interpolation = WaveshaperTable::Interpolation;
+
+    constexpr auto kLastPoint    = static_cast<float>(WaveshaperTable::kPointsPerSlice);
+    constexpr int kChunkSize     = 256;
+    constexpr float kSnapToSlice = 1.0e-3f;  // In slices, settled drives are multiples of 0.1 dB up to float rounding
+
+    std::atomic<const WaveshaperTable*> gInstance {nullptr};
+
+    // Written with comparisons that are false for NaN, so NaN ends up at 0 and the int conversion is always defined
+    float clampPosition(float position, float upper) {
+        return position > 0.0f ? (position < upper ? position : upper) : 0.0f;
+    }
+
+    int nearestSlice(float driveDb) {
+        const auto position = clampPosition(driveDb / WaveshaperTable::kDriveStepDb, WaveshaperTable::kNumSlices - 1);
+        return static_cast<int>(position + 0.5f);
+    }
+
+    template<Interpolation interpolation>
+    float interpolate(const float* points, float t) {
+        if constexpr (interpolation == Interpolation::linear) {
+            return points[0] + t * (points[1] - points[0]);
+        } else {
+            const float ym1 = points[-1];
+            const float y0  = points[0];
+            const float y1  = points[1];
+            const float y2  = points[2];
+
+            const float c1 = 0.5f * (y1 - ym1);
+            const float c2 = ym1 - 2.5f * y0 + 2.0f * y1 - 0.5f * y2;
+            const float c3 = 0.5f * (y2 - ym1) + 1.5f * (y0 - y1);
+            return ((c3 * t + c2) * t + c1) * t + y0;
+        }
+    }
+
+    // The curve is odd, but a slice value can itself be negative (the harmonic dips below zero), so no copysign
+    float restoreSign(float input, float y) {
+        return input < 0.0f ? -y : y;
+    }
+
+    template<Interpolation interpolation>
+    float readSample(const float* slice, float inverseStep, float input) {
+        const float position = clampPosition(std::abs(input) * inverseStep, kLastPoint);
+        const int index      = static_cast<int>(position);
+        return restoreSign(input, interpolate<interpolation>(slice + index, position - static_cast<float>(index)));
+    }
+
+    template<Interpolation interpolation>
+    void readSlice(const float* slice, float inverseStep, float* data, int numSamples) {
+        constexpr int numPoints  = interpolation == Interpolation::cubic ? 4 : 2;
+        constexpr int firstPoint = interpolation == Interpolation::cubic ? -1 : 0;
+
+        std::array<int, kChunkSize> indices;
+        std::array<float, kChunkSize> fractions;
+        std::array<std::array<float, kChunkSize>, numPoints> points;
+
+        for (int start = 0; start < numSamples; start += kChunkSize) {
+            auto* chunk      = data + start;
+            const auto count = juce::jmin(kChunkSize, numSamples - start);
+
+            for (int i = 0; i < count; ++i) {
+                const float position = clampPosition(std::abs(chunk[i]) * inverseStep, kLastPoint);
+                indices[i]           = static_cast<int>(position);
+                fractions[i]         = position - static_cast<float>(indices[i]);
+            }
+
+            // The gathers, the one part that stays scalar
+            for (int i = 0; i < count; ++i) {
+                for (int point = 0; point < numPoints; ++point) {
+                    points[static_cast<size_t>(point)][i] = slice[indices[i] + firstPoint + point];
+                }
+            }
+
+            for (int i = 0; i < count; ++i) {
+                float neighbours[numPoints];
+                for (int point = 0; point < numPoints; ++point) {
+                    neighbours[point] = points[static_cast<size_t>(point)][i];
+                }
+                chunk[i] = restoreSign(chunk[i], interpolate<interpolation>(neighbours - firstPoint, fractions[i]));
+            }
+        }
+    }
+}  // namespace
+
+void WaveshaperTable::build() {
+    gInstance.store(&getInstance(), std::memory_order_release);
+}
+
+void WaveshaperTable::buildAsync() {
+    static TableBuilder builder("Greg waveshaper table", build, isReady);
+    builder.start();
+}
+
+bool WaveshaperTable::isReady() {
+    return gInstance.load(std::memory_order_acquire) != nullptr;
+}
+
+const WaveshaperTable& WaveshaperTable::getInstance() {
+    static const WaveshaperTable instance;
+    return instance;
+}
+
+bool WaveshaperTable::isOnSlice(float driveDb) {
+    const float position = driveDb / kDriveStepDb;
+    const float nearest  = std::round(position);
+    const bool inRange   = nearest >= 0.0f && nearest <= static_cast<float>(kNumSlices - 1);
+    return inRange && std::abs(position - nearest) < kSnapToSlice;
+}
+
+WaveshaperTable::WaveshaperTable()
+    : mPoints(static_cast<size_t>(kNumSlices * kSliceStride)), mInverseSteps(static_cast<size_t>(kNumSlices)) {
+    for (int slice = 0; slice < kNumSlices; ++slice) {
+        const double drive = sliceDrive(slice);
+        // Beyond 9/d + 0.3 the tanh argument is at least 9, which is 1 in float
+        const double range = 9.0 / drive + 0.3;
+        const double step  = range / kPointsPerSlice;
+
+        mInverseSteps[static_cast<size_t>(slice)] = static_cast<float>(1.0 / step);
+
+        auto* points = mPoints.data() + slice * kSliceStride + 1;
+        for (int i = -1; i <= kPointsPerSlice + 2; ++i) {
+            points[i] = static_cast<float>(analyticCurve(i * step, drive));
+        }
+    }
+}
+
+float WaveshaperTable::processSample(float input, float driveDb, Interpolation interpolation) const {
+    const auto index       = nearestSlice(driveDb);
+    const auto* slice      = getSlice(index);
+    const auto inverseStep = mInverseSteps[static_cast<size_t>(index)];
+
+    if (interpolation == Interpolation::cubic) return readSample<Interpolation::cubic>(slice, inverseStep, input);
+    return readSample<Interpolation::linear>(slice, inverseStep, input);
+}
+
+void WaveshaperTable::process(float* data, float driveDb, int numSamples, Interpolation interpolation) const {
+    jassert(isOnSlice(driveDb));
+
+    // The slice lookup happens once per block, the loops are reads and arithmetic only
+    const auto index       = nearestSlice(driveDb);
+    const auto* slice      = getSlice(index);
+    const auto inverseStep = mInverseSteps[static_cast<size_t>(index)];
+
+    if (interpolation == Interpolation::cubic) readSlice<Interpolation::cubic>(slice, inverseStep, data, numSamples);
+    else readSlice<Interpolation::linear>(slice, inverseStep, data, numSamples);
+}
+
+WaveshaperTable::Accuracy WaveshaperTable::measureAccuracy(Interpolation interpolation) const {
+    constexpr double inputRange = 12.0;
+    constexpr int numInputs     = 20001;
+
+    Accuracy accuracy;
+    double sumOfSquares = 0.0;
+    int64_t count       = 0;
+
+    for (int slice = 0; slice < kNumSlices; ++slice) {
+        const float driveDb = static_cast<float>(slice) * kDriveStepDb;
+        const double drive  = std::pow(10.0, driveDb / 20.0);
+
+        for (int i = 0; i < numInputs; ++i) {
+            const auto input   = static_cast<float>(-inputRange + 2.0 * inputRange * i / (numInputs - 1));
+            const double error = std::abs(processSample(input, driveDb, interpolation) - analyticCurve(input, drive));
+
+            accuracy.maxError = juce::jmax(accuracy.maxError, error);
+            sumOfSquares += error * error;
+            ++count;
+        }
+    }
+
+    accuracy.rmsError = std::sqrt(sumOfSquares / static_cast<double>(count));
+    return accuracy;
+}
@@ -0,0 +1,766 @@
+// Headless throughput and regression harness for GregProcessor.
+//
+// Sweeps sample rates, block sizes and oversampling settings with automated parameters and reports ns/sample,
+// realtime factor and p50/p99/max callback times. It can also render golden files and check later builds against
+// them. Run with --help for the options.
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <chrono>
+#include <iostream>
+
+#include "AllocationGuard.hpp"
+#include "EditorAssets.hpp"
+#include "PluginEditor.hpp"
+#include "PluginProcessor.hpp"
+#include "TelemetryLogger.hpp"
+
+namespace {
+    struct Options {
+        juce::Array<double> sampleRates {44100.0, 48000.0, 96000.0};
+        juce::Array<int> blockSizes {32, 64, 128, 256, 512, 1024};
+        juce::Array<int> qualities {1, 2, 3, 4};  // Oversampling order, 2^n
+        int numChannels       = 2;
+        int antialiasingOrder = 0;
+        int numBands          = 1;  // More than one runs the multiband path and checks its CPU budget
+        int stereoMode        = 0;  // The "stereo" choice: 0 stereo, 1 mid/side, 2 linked
+        double seconds        = 5.0;
+        bool automate         = true;
+        bool offline          = false;
+        bool doublePrecision  = false;
+        bool scalar           = false;
+        bool table            = false;
+        bool verify           = false;
+        bool csv              = false;
+        bool aliasing         = false;
+        double maxNsPerSample = 0.0;    // 0 disables the gate
+        int stateIterations   = 0;      // Non-zero runs the state benchmark instead of the sweep
+        int editorOpens       = 0;      // Non-zero times opening editors instead of the sweep
+        bool editorSync       = false;  // Time the editor's old synchronous asset loading instead
+
+        bool telemetry = false;
+        juce::File telemetryFile;  // Empty logs to stdout
+
+        juce::File goldenDirectory;
+        bool writeGolden       = false;
+        double goldenTolerance = 0.0;  // 0 means bit-exact
+    };
+
+    struct Result {
+        double nsPerSample    = 0.0;
+        double realtimeFactor = 0.0;
+        double p50Micros      = 0.0;
+        double p99Micros      = 0.0;
+        double maxMicros      = 0.0;
+        double deadlineMicros = 0.0;
+    };
+
+    void printUsage() {
+        std::cout << "Usage: GregBench [options]\n"
+                     "  --sample-rates=44100,48000,96000  Sample rates to sweep\n"
+                     "  --block-sizes=32,64,...,1024      Host block sizes to sweep\n"
+                     "  --qualities=1,2,3,4               Oversampling orders to sweep (0 = 1x ... 4 = 16x)\n"
+                     "  --channels=2                      Bus width, e.g. 1, 6 for 5.1 or 12 for 7.1.4\n"
+                     "  --adaa=0                          Antiderivative anti-aliasing order, 0 (off), 1 or 2\n"
+                     "  --bands=1                         Multiband saturation with 3 or 4 bands, against its budget\n"
+                     "  --stereo=0                        0 stereo, 1 mid/side (side drive +6 dB) or 2 linked\n"
+                     "  --seconds=5                       Audio length per run\n"
+                     "  --static                          Don't automate parameters\n"
+                     "  --offline                         Run with isNonRealtime() set\n"
+                     "  --double                          Process in double precision, as 64 bit hosts do\n"
+                     "  --scalar                          Use the exact scalar shaper instead of the SIMD kernel\n"
+                     "  --table                           Shape from the curve table at settled drives (see --static)\n"
+                     "  --verify                          Run the self-checks, gate smoothing, ADAA and the guard\n"
+                     "  --state[=N]                       Time N state saves/loads, binary against XML, then exit\n"
+                     "  --aliasing                        Compare aliasing and cost of ADAA and oversampling\n"
+                     "  --editor[=N]                      Time N editor opens to their first paint, then exit\n"
+                     "  --editor-sync                     With --editor, time the old synchronous asset loading\n"
+                     "  --csv                             Print results as CSV\n"
+                     "  --telemetry[=FILE]                Log per-block stage timings to FILE, or stdout\n"
+                     "  --max-ns-per-sample=N             Fail if any run is slower than N ns/sample\n"
+                     "  --golden=DIR                      Compare renders against the golden files in DIR\n"
+                     "  --write-golden                    Write the golden files to DIR instead of comparing\n"
+                     "  --tolerance=0                     Allowed max abs difference against golden (0 = exact)\n";
+    }
+
+    template<typename T>
+    juce::Array<T> parseList(const juce::String& text) {
+        juce::Array<T> values;
+        for (const auto& token : juce::StringArray::fromTokens(text, ",", {})) {
+            if constexpr (std::is_same_v<T, int>) {
+                values.add(token.getIntValue());
+            } else {
+                values.add(static_cast<T>(token.getDoubleValue()));
+            }
+        }
+        return values;
+    }
+
+    Options parseOptions(const juce::ArgumentList& args) {
+        Options options;
+
+        if (args.containsOption("--sample-rates")) {
+            options.sampleRates = parseList<double>(args.getValueForOption("--sample-rates"));
+        }
+        if (args.containsOption("--block-sizes")) {
+            options.blockSizes = parseList<int>(args.getValueForOption("--block-sizes"));
+        }
+        if (args.containsOption("--qualities")) {
+            options.qualities = parseList<int>(args.getValueForOption("--qualities"));
+        }
+        if (args.containsOption("--channels")) {
+            options.numChannels = juce::jmax(1, args.getValueForOption("--channels").getIntValue());
+        }
+        if (args.containsOption("--adaa")) {
+            options.antialiasingOrder = juce::jlimit(0, 2, args.getValueForOption("--adaa").getIntValue());
+        }
+        if (args.containsOption("--bands")) {
+            const auto numBands = args.getValueForOption("--bands").getIntValue();
+            options.numBands    = numBands >= 3 ? juce::jmin(numBands, MultibandSaturatorBase::kMaxBands) : 1;
+        }
+        if (args.containsOption("--stereo")) {
+            options.stereoMode = juce::jlimit(0, 2, args.getValueForOption("--stereo").getIntValue());
+        }
+        if (args.containsOption("--seconds")) {
+            options.seconds = args.getValueForOption("--seconds").getDoubleValue();
+        }
+        if (args.containsOption("--max-ns-per-sample")) {
+            options.maxNsPerSample = args.getValueForOption("--max-ns-per-sample").getDoubleValue();
+        }
+        if (args.containsOption("--tolerance")) {
+            options.goldenTolerance = args.getValueForOption("--tolerance").getDoubleValue();
+        }
+        if (args.containsOption("--golden")) {
+            const auto path         = args.getValueForOption("--golden");
+            options.goldenDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(path);
+        }
+
+        if (args.containsOption("--state")) {
+            options.stateIterations = args.getValueForOption("--state").getIntValue();
+            if (options.stateIterations <= 0) options.stateIterations = 10000;
+        }
+        if (args.containsOption("--editor")) {
+            options.editorOpens = args.getValueForOption("--editor").getIntValue();
+            if (options.editorOpens <= 0) options.editorOpens = 20;
+        }
+        options.editorSync = args.containsOption("--editor-sync");
+        if (args.containsOption("--telemetry")) {
+            const auto path       = args.getValueForOption("--telemetry");
+            options.telemetry     = true;
+            options.telemetryFile = path.isEmpty() ? juce::File()
+                                                   : juce::File::getCurrentWorkingDirectory().getChildFile(path);
+        }
+
+        options.automate        = !args.containsOption("--static");
+        options.offline         = args.containsOption("--offline");
+        options.doublePrecision = args.containsOption("--double");
+        options.scalar          = args.containsOption("--scalar");
+        options.table           = args.containsOption("--table");
+        options.verify          = args.containsOption("--verify");
+        options.csv             = args.containsOption("--csv");
+        options.aliasing        = args.containsOption("--aliasing");
+        options.writeGolden     = args.containsOption("--write-golden");
+
+        return options;
+    }
+
+    // Deterministic programme material: a slow sine sweep under seeded noise, with a few silent gaps
+    juce::AudioBuffer<float> makeInput(double sampleRate, double seconds, int numChannels) {
+        const auto numSamples = static_cast<int>(sampleRate * seconds);
+        juce::AudioBuffer<float> input(numChannels, numSamples);
+        juce::Random random(1234);
+
+        double phase = 0.0;
+        for (int i = 0; i < numSamples; ++i) {
+            const double t         = i / sampleRate;
+            const double frequency = 40.0 * std::pow(400.0, std::fmod(t, seconds) / seconds);
+            phase += juce::MathConstants<double>::twoPi * frequency / sampleRate;
+
+            const bool gap = std::fmod(t, 2.0) > 1.8;
+            for (int channel = 0; channel < numChannels; ++channel) {
+                const float noise = (random.nextFloat() * 2.0f - 1.0f) * 0.05f;
+                const float tone  = static_cast<float>(std::sin(phase + channel * 0.5)) * 0.5f;
+                input.setSample(channel, i, gap ? 0.0f : tone + noise);
+            }
+        }
+
+        return input;
+    }
+
+    void setParameter(GregProcessor& processor, const juce::String& id, float value) {
+        if (auto* parameter = processor.mParameters.getParameter(id)) {
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        }
+    }
+
+    // Moves every continuous parameter along its own slow LFO, at block rate like a host would
+    void automate(GregProcessor& processor, double timeSeconds) {
+        const auto lfo = [timeSeconds](double rate) {
+            const auto phase = juce::MathConstants<double>::twoPi * rate * timeSeconds;
+            return 0.5f + 0.5f * static_cast<float>(std::sin(phase));
+        };
+
+        setParameter(processor, "drive", 30.0f * lfo(0.5));
+        setParameter(processor, "tone", 100.0f * lfo(0.3));
+        setParameter(processor, "mix", 50.0f + 50.0f * lfo(0.2));
+        setParameter(processor, "output", -12.0f + 12.0f * lfo(0.7));
+    }
+
+    std::unique_ptr<GregProcessor>
+    createProcessor(const Options& options, double sampleRate, int blockSize, int quality) {
+        auto processor = std::make_unique<GregProcessor>();
+
+        processor->setNonRealtime(options.offline);
+        processor->setProcessingPrecision(options.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                                  : juce::AudioProcessor::singlePrecision);
+        processor->getTelemetry().setEnabled(options.telemetry);
+        processor->setSaturationMode(options.scalar ? SaturationKernel::Mode::scalar
+                                                    : SaturationKernel::Mode::vectorized);
+
+        setParameter(*processor, "quality", static_cast<float>(quality));
+        setParameter(*processor, "renderQuality", static_cast<float>(quality));
+        setParameter(*processor, "antialiasing", static_cast<float>(options.antialiasingOrder));
+        setParameter(*processor, "shaper", options.table ? 1.0f : 0.0f);
+        setParameter(*processor, "bands", options.numBands > 1 ? static_cast<float>(options.numBands - 2) : 0.0f);
+        setParameter(*processor, "stereo", static_cast<float>(options.stereoMode));
+        setParameter(*processor, "sideDrive", 6.0f);  // Only heard in mid/side
+        setParameter(*processor, "drive", 12.0f);
+        setParameter(*processor, "tone", 70.0f);
+
+        processor->setPlayConfigDetails(options.numChannels, options.numChannels, sampleRate, blockSize);
+        processor->prepareToPlay(sampleRate, blockSize);
+        return processor;
+    }
+
+    // Runs the input through the processor in host sized blocks, timing every callback
+    template<typename SampleType>
+    Result runBlocks(GregProcessor& processor,
+                     juce::AudioBuffer<SampleType>& audio,
+                     const Options& options,
+                     double sampleRate,
+                     int blockSize) {
+        const auto numChannels = audio.getNumChannels();
+        juce::AudioBuffer<SampleType> block(numChannels, blockSize);
+        juce::MidiBuffer midi;
+        std::vector<double> callbackMicros;
+        callbackMicros.reserve(static_cast<size_t>(audio.getNumSamples() / blockSize + 1));
+
+        double totalSeconds = 0.0;
+
+        for (int start = 0; start < audio.getNumSamples(); start += blockSize) {
+            const auto numSamples = juce::jmin(blockSize, audio.getNumSamples() - start);
+            block.setSize(numChannels, numSamples, false, false, true);
+            for (int channel = 0; channel < numChannels; ++channel) {
+                block.copyFrom(channel, 0, audio, channel, start, numSamples);
+            }
+
+            if (options.automate) automate(processor, start / sampleRate);
+
+            const auto begin = std::chrono::steady_clock::now();
+            processor.processBlock(block, midi);
+            const auto end = std::chrono::steady_clock::now();
+
+            const auto seconds = std::chrono::duration<double>(end - begin).count();
+            totalSeconds += seconds;
+            callbackMicros.push_back(seconds * 1.0e6);
+
+            for (int channel = 0; channel < numChannels; ++channel) {
+                audio.copyFrom(channel, start, block, channel, 0, numSamples);
+            }
+        }
+
+        std::sort(callbackMicros.begin(), callbackMicros.end());
+        const auto percentile = [&](double p) {
+            const auto index = static_cast<size_t>(p * static_cast<double>(callbackMicros.size() - 1));
+            return callbackMicros[index];
+        };
+
+        Result result;
+        result.nsPerSample    = totalSeconds * 1.0e9 / audio.getNumSamples();
+        result.realtimeFactor = (audio.getNumSamples() / sampleRate) / totalSeconds;
+        result.p50Micros      = percentile(0.5);
+        result.p99Micros      = percentile(0.99);
+        result.maxMicros      = callbackMicros.back();
+        result.deadlineMicros = blockSize / sampleRate * 1.0e6;
+        return result;
+    }
+
+    // The test material is generated and compared in float, a double precision run converts on the way in and out
+    Result run(GregProcessor& processor,
+               juce::AudioBuffer<float>& audio,
+               const Options& options,
+               double sampleRate,
+               int blockSize) {
+        if (!options.doublePrecision) return runBlocks(processor, audio, options, sampleRate, blockSize);
+
+        juce::AudioBuffer<double> doubleAudio;
+        doubleAudio.makeCopyOf(audio);
+        const auto result = runBlocks(processor, doubleAudio, options, sampleRate, blockSize);
+        audio.makeCopyOf(doubleAudio);
+        return result;
+    }
+
+    juce::File getGoldenFile(const Options& options, double sampleRate, int quality) {
+        const auto adaa   = options.antialiasingOrder > 0 ? "_adaa" + juce::String(options.antialiasingOrder) : "";
+        const auto bands  = options.numBands > 1 ? "_" + juce::String(options.numBands) + "bands" : "";
+        const auto stereo = options.stereoMode == 1 ? "_ms" : options.stereoMode == 2 ? "_linked" : "";
+        const auto name   = juce::String::formatted("greg_%d_%dx%s%s%s%s%s%s.wav",
+                                                    static_cast<int>(sampleRate),
+                                                    1 << quality,
+                                                    adaa.toRawUTF8(),
+                                                    bands.toRawUTF8(),
+                                                    stereo,
+                                                    options.table ? "_table" : "",
+                                                    options.offline ? "_offline" : "",
+                                                    options.doublePrecision ? "_double" : "");
+        return options.goldenDirectory.getChildFile(name);
+    }
+
+    bool writeWav(const juce::File& file, const juce::AudioBuffer<float>& audio, double sampleRate) {
+        file.deleteFile();
+        auto stream = file.createOutputStream();
+        if (stream == nullptr) return false;
+
+        // 32 bit float, so golden comparisons aren't limited by quantisation
+        juce::WavAudioFormat wav;
+        const auto numChannels = static_cast<unsigned int>(audio.getNumChannels());
+        std::unique_ptr<juce::AudioFormatWriter> writer(
+          wav.createWriterFor(stream.get(), sampleRate, numChannels, 32, {}, 0));
+        if (writer == nullptr) return false;
+        stream.release();  // Owned by the writer now
+
+        return writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples());
+    }
+
+    bool readWav(const juce::File& file, juce::AudioBuffer<float>& audio) {
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatReader> reader(
+          wav.createReaderFor(file.createInputStream().release(), true));
+        if (reader == nullptr) return false;
+
+        audio.setSize(static_cast<int>(reader->numChannels), static_cast<int>(reader->lengthInSamples));
+        return reader->read(&audio, 0, audio.getNumSamples(), 0, true, true);
+    }
+
+    // Returns false if the render strays further from the golden file than the tolerance allows
+    bool checkGolden(const Options& options, const juce::AudioBuffer<float>& render, double sampleRate, int quality) {
+        const auto file = getGoldenFile(options, sampleRate, quality);
+
+        if (options.writeGolden) {
+            options.goldenDirectory.createDirectory();
+            const bool written = writeWav(file, render, sampleRate);
+            std::cout << (written ? "wrote " : "FAILED to write ") << file.getFullPathName() << "\n";
+            return written;
+        }
+
+        juce::AudioBuffer<float> golden;
+        if (!readWav(file, golden) || golden.getNumChannels() != render.getNumChannels()
+            || golden.getNumSamples() != render.getNumSamples()) {
+            std::cout << "golden " << file.getFileName() << ": missing or wrong size\n";
+            return false;
+        }
+
+        double maxError = 0.0;
+        for (int channel = 0; channel < render.getNumChannels(); ++channel) {
+            for (int i = 0; i < render.getNumSamples(); ++i) {
+                const double error = std::abs(render.getSample(channel, i) - golden.getSample(channel, i));
+                maxError           = juce::jmax(maxError, error);
+            }
+        }
+
+        const bool passed = maxError <= options.goldenTolerance;
+        std::cout << "golden " << file.getFileName() << ": max abs error " << maxError
+                  << (passed ? " (ok)" : " (FAILED)") << "\n";
+        return passed;
+    }
+
+    // Times getStateInformation/setStateInformation in the binary format against the older XML one
+    bool runStateBenchmark(int iterations) {
+        GregProcessor processor;
+        setParameter(processor, "drive", 12.3f);
+        setParameter(processor, "tone", 45.6f);
+        setParameter(processor, "mix", 78.9f);
+        setParameter(processor, "output", -4.5f);
+        setParameter(processor, "quality", 3.0f);
+
+        const auto timeMicros = [iterations](auto&& operation) {
+            const auto begin = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i) {
+                operation();
+            }
+            const auto end = std::chrono::steady_clock::now();
+            return std::chrono::duration<double, std::micro>(end - begin).count() / iterations;
+        };
+
+        juce::MemoryBlock binary;
+        juce::MemoryBlock xml;
+
+        const auto saveBinary = timeMicros([&] {
+            binary.setSize(0);
+            processor.getStateInformation(binary);
+        });
+        const auto saveXml = timeMicros([&] {
+            xml.setSize(0);
+            processor.getXmlStateInformation(xml);
+        });
+
+        const auto binarySize = static_cast<int>(binary.getSize());
+        const auto xmlSize    = static_cast<int>(xml.getSize());
+
+        const auto loadXml    = timeMicros([&] { processor.setStateInformation(xml.getData(), xmlSize); });
+        const auto loadBinary = timeMicros([&] { processor.setStateInformation(binary.getData(), binarySize); });
+
+        // Both formats have to restore the same values
+        juce::MemoryBlock fromXml;
+        processor.setStateInformation(xml.getData(), xmlSize);
+        processor.getStateInformation(fromXml);
+        const bool roundTrips = fromXml == binary;
+
+        std::cout << juce::String::formatted("State, %d iterations\n"
+                                             "  binary      save %8.2f us  load %8.2f us  %5d bytes\n"
+                                             "  XML         save %8.2f us  load %8.2f us  %5d bytes\n"
+                                             "  round trip  %s\n",
+                                             iterations,
+                                             saveBinary,
+                                             loadBinary,
+                                             binarySize,
+                                             saveXml,
+                                             loadXml,
+                                             xmlSize,
+                                             roundTrips ? "ok" : "FAILED");
+        return roundTrips;
+    }
+
+    // Times editor opens up to their first paint. The first open in the process is the cold one. With the shared
+    // assets it starts the decoding thread and paints the placeholder, the artwork follows once EditorAssets is ready,
+    // and the later opens find everything decoded. With synchronous (the path from before EditorAssets) every editor
+    // takes its PNGs from ImageCache and draws the full size background, the cold one decoding them first. Run once
+    // with and once without --editor-sync, each in its own process, for the before and after figures.
+    void runEditorReport(int opens, bool synchronous) {
+        using Clock            = std::chrono::steady_clock;
+        const auto millisSince = [](Clock::time_point begin) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+        };
+
+        GregEditor::setAssetLoading(synchronous ? GregEditor::AssetLoading::synchronous
+                                                : GregEditor::AssetLoading::shared);
+
+        GregProcessor processor;
+        const auto paint = [](juce::Component& editor) { editor.createComponentSnapshot(editor.getLocalBounds()); };
+
+        auto begin = Clock::now();
+        std::unique_ptr<juce::AudioProcessorEditor> editor(processor.createEditor());
+        paint(*editor);
+        const auto coldFirstPaint = millisSince(begin);
+
+        if (!synchronous) {
+            while (!EditorAssets::getInstance()->isReady()) juce::Thread::sleep(1);
+            paint(*editor);
+        }
+        const auto coldArtwork = millisSince(begin);
+        editor.reset();
+
+        double warmTotal = 0.0;
+        double warmMax   = 0.0;
+        for (int i = 0; i < opens; ++i) {
+            begin = Clock::now();
+            editor.reset(processor.createEditor());
+            paint(*editor);
+            const auto millis = millisSince(begin);
+            editor.reset();
+
+            warmTotal += millis;
+            warmMax = juce::jmax(warmMax, millis);
+        }
+
+        std::cout << juce::String::formatted("Editor open to first paint, %s assets, %d warm opens\n"
+                                             "  cold  first paint %7.2f ms  artwork %7.2f ms\n"
+                                             "  warm  mean %7.2f ms  max %7.2f ms\n",
+                                             synchronous ? "synchronous" : "shared",
+                                             opens,
+                                             coldFirstPaint,
+                                             coldArtwork,
+                                             warmTotal / opens,
+                                             warmMax);
+    }
+
+    // Shapes a bin-centred sine at high drive and sums everything that lands off its harmonics, relative to the
+    // fundamental. A rectangular window is exact here, the steady state output repeats every FFT frame.
+    void runAliasingReport() {
+        constexpr double sampleRate = 48000.0;
+        constexpr int fftOrder      = 16;
+        constexpr int fftSize       = 1 << fftOrder;
+        constexpr int bin           = 5461;  // About 4 kHz, odd so the folded harmonics miss the real ones
+        constexpr int warmUp        = 8192;  // Lets the oversampling and tone filters settle
+        constexpr int blockSize     = 512;
+
+        struct Setting {
+            int antialiasingOrder;
+            int oversamplingOrder;
+        };
+
+        // Direct shaping at every factor, ADAA where it competes with the higher ones
+        constexpr Setting settings[] = {{0, 0}, {0, 1}, {0, 2}, {0, 3}, {0, 4}, {1, 0}, {1, 1}, {1, 2}, {2, 0}, {2, 1}};
+        const char* const names[]    = {"direct", "ADAA", "ADAA 2"};
+
+        AntiderivativeShaper::buildTable();
+        juce::dsp::FFT fft(fftOrder);
+
+        const auto frequency = bin * sampleRate / fftSize;
+        std::cout << juce::String::formatted("Aliasing, %.1f Hz sine at -6 dBFS, 24 dB drive\n", frequency);
+
+        for (const auto& setting : settings) {
+            GregEngineBase::Parameters parameters;
+            parameters.drive                   = 24.0f;
+            parameters.oversamplingOrder       = setting.oversamplingOrder;
+            parameters.renderOversamplingOrder = setting.oversamplingOrder;
+            parameters.antialiasingOrder       = setting.antialiasingOrder;
+
+            GregEngine<float> engine;
+            engine.prepare(sampleRate, 1, blockSize, parameters, false);
+
+            juce::AudioBuffer<float> audio(1, warmUp + fftSize);
+            for (int i = 0; i < audio.getNumSamples(); ++i) {
+                const auto phase = juce::MathConstants<double>::twoPi * ((static_cast<juce::int64>(i) * bin) % fftSize);
+                audio.setSample(0, i, 0.5f * static_cast<float>(std::sin(phase / fftSize)));
+            }
+
+            const auto begin = std::chrono::steady_clock::now();
+            for (int start = 0; start < audio.getNumSamples(); start += blockSize) {
+                const auto numSamples = juce::jmin(blockSize, audio.getNumSamples() - start);
+                juce::AudioBuffer<float> block(audio.getArrayOfWritePointers(), 1, start, numSamples);
+                engine.process(block, parameters, false);
+            }
+            const auto end = std::chrono::steady_clock::now();
+
+            std::vector<float> spectrum(2 * fftSize, 0.0f);
+            std::copy_n(audio.getReadPointer(0, warmUp), fftSize, spectrum.begin());
+            fft.performFrequencyOnlyForwardTransform(spectrum.data());
+
+            const auto power = [&spectrum](int index) {
+                const auto magnitude = static_cast<double>(spectrum[static_cast<size_t>(index)]);
+                return magnitude * magnitude;
+            };
+
+            double aliasing = 0.0;
+            for (int i = 1; i <= fftSize / 2; ++i) {
+                if (i % bin != 0) aliasing += power(i);
+            }
+
+            const auto fundamental = power(bin);
+            const auto nanoseconds = std::chrono::duration<double, std::nano>(end - begin).count();
+
+            std::cout << juce::String::formatted("  %-6s %2dx  aliasing %7.1f dB  %8.2f ns/smp\n",
+                                                 names[setting.antialiasingOrder],
+                                                 1 << setting.oversamplingOrder,
+                                                 10.0 * std::log10(aliasing / fundamental),
+                                                 nanoseconds / audio.getNumSamples());
+        }
+    }
+
+    struct SmoothingDeviation {
+        float maxRampError         = 0.0f;  // Absolute, in parameter units
+        float maxRelativeGainError = 0.0f;
+    };
+
+    // Runs a set of ramps through BlockSmoother::render()/renderDecibelsToGain() and through the reference,
+    // SmoothedValue::getNextValue() plus Decibels::decibelsToGain(), and returns the largest differences
+    SmoothingDeviation measureSmoothingDeviation() {
+        constexpr int blockSize                   = 512;
+        constexpr std::pair<float, float> ramps[] = {{0.0f, 30.0f}, {30.0f, 0.0f}, {-30.0f, 12.3f}, {5.0f, 5.1f}};
+
+        std::array<float, blockSize> rendered {};
+        SmoothingDeviation deviation;
+
+        for (const auto sampleRate : {44100.0, 96000.0, 768000.0}) {
+            for (const auto& [start, target] : ramps) {
+                BlockSmoother smoother;
+                juce::SmoothedValue<float> reference;
+
+                smoother.reset(sampleRate, 0.01);
+                reference.reset(sampleRate, 0.01);
+                smoother.setCurrentAndTargetValue(start);
+                reference.setCurrentAndTargetValue(start);
+                smoother.setTargetValue(target);
+                reference.setTargetValue(target);
+
+                // Run past the end of the ramp, so the settled tail is covered too
+                for (int processed = 0; processed < static_cast<int>(sampleRate * 0.015); processed += blockSize) {
+                    auto rampSmoother  = smoother;
+                    auto rampReference = reference;
+
+                    rampSmoother.render(rendered.data(), blockSize);
+                    for (const auto value : rendered) {
+                        const auto error       = std::abs(value - rampReference.getNextValue());
+                        deviation.maxRampError = juce::jmax(deviation.maxRampError, error);
+                    }
+
+                    smoother.renderDecibelsToGain(rendered.data(), blockSize);
+                    for (const auto value : rendered) {
+                        const auto expected = juce::Decibels::decibelsToGain(reference.getNextValue());
+                        const auto error    = std::abs(value - expected) / expected;
+                        deviation.maxRelativeGainError = juce::jmax(deviation.maxRelativeGainError, error);
+                    }
+                }
+            }
+        }
+
+        return deviation;
+    }
+
+    // Provokes the allocation the guard exists for, AudioBuffer::makeCopyOf() growing its HeapBlock through malloc
+    // rather than operator new, and returns whether the guard saw it. Builds without the guard pass.
+    bool checkAllocationGuard() {
+#if GREG_ENABLE_ALLOCATION_GUARD
+        juce::AudioBuffer<float> source(2, 512);
+        juce::AudioBuffer<float> copy;
+        source.clear();
+
+        const auto numCountedBefore = ScopedAllocationGuard::getNumCountedCalls();
+        {
+            ScopedAllocationGuard guard(ScopedAllocationGuard::Mode::counting);
+            copy.makeCopyOf(source);
+        }
+        const bool caught = ScopedAllocationGuard::getNumCountedCalls() > numCountedBefore;
+
+        std::cout << "  allocation guard on AudioBuffer::makeCopyOf: " << (caught ? "ok" : "FAILED") << "\n";
+        return caught;
+#else
+        std::cout << "  allocation guard: compiled out in this build\n";
+        return true;
+#endif
+    }
+
+    // Prints the accuracy of the DSP building blocks. Fails if the block smoothing strays from SmoothedValue by more
+    // than BlockSmoother.hpp allows or the allocation guard misses a heap call, the table figures are for information.
+    bool runSelfChecks() {
+        constexpr float maxRampError      = 2e-3f;  // dB
+        constexpr float maxGainError      = 2e-4f;  // Relative
+        constexpr double maxMidSliceError = 1e-3;   // About twice the ADAA table's error on a slice
+
+        std::cout << "Self-checks\n";
+
+        const auto smoothing   = measureSmoothingDeviation();
+        const bool smoothingOk = smoothing.maxRampError <= maxRampError
+                              && smoothing.maxRelativeGainError <= maxGainError;
+        std::cout << "  block smoothing vs SmoothedValue: ramp " << smoothing.maxRampError << " (limit " << maxRampError
+                  << "), gain (relative) " << smoothing.maxRelativeGainError << " (limit " << maxGainError << ")  "
+                  << (smoothingOk ? "ok" : "FAILED") << "\n";
+
+        using Interpolation = WaveshaperTable::Interpolation;
+
+        const auto& table = WaveshaperTable::getInstance();
+        for (const auto interpolation : {Interpolation::linear, Interpolation::cubic}) {
+            const auto name = interpolation == Interpolation::cubic ? "cubic" : "linear";
+            const auto accuracy = table.measureAccuracy(interpolation);
+            std::cout << "  waveshaper table (" << name << "): max " << accuracy.maxError << ", rms "
+                      << accuracy.rmsError << "\n";
+        }
+
+        const auto antiderivatives = AntiderivativeShaper::measureAccuracy();
+        const bool antiderivativesOk = antiderivatives.maxMidSliceError <= maxMidSliceError;
+        std::cout << "  antiderivative table: curve " << antiderivatives.maxCurveError << ", first antiderivative "
+                  << antiderivatives.maxFirstError << ", between slices " << antiderivatives.maxMidSliceError
+                  << " (limit " << maxMidSliceError << ")  " << (antiderivativesOk ? "ok" : "FAILED") << "\n";
+
+        const bool guardOk = checkAllocationGuard();
+
+        std::cout << "\n";
+        return smoothingOk && antiderivativesOk && guardOk;
+    }
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h")) {
+        printUsage();
+        return 0;
+    }
+
+    const auto options = parseOptions(args);
+    bool passed        = true;
+
+    if (options.verify) passed = runSelfChecks();
+    if (options.stateIterations > 0) return runStateBenchmark(options.stateIterations) && passed ? 0 : 1;
+    if (options.editorOpens > 0) {
+        runEditorReport(options.editorOpens, options.editorSync);
+        return passed ? 0 : 1;
+    }
+    if (options.aliasing) {
+        runAliasingReport();
+        return passed ? 0 : 1;
+    }
+
+    if (options.csv) {
+        std::cout << "sample_rate,block_size,oversampling,ns_per_sample,realtime_factor,p50_us,p99_us,max_us,"
+                     "deadline_us\n";
+    }
+
+    for (const auto sampleRate : options.sampleRates) {
+        for (const auto quality : options.qualities) {
+            for (const auto blockSize : options.blockSizes) {
+                auto processor = createProcessor(options, sampleRate, blockSize, quality);
+                auto audio     = makeInput(sampleRate, options.seconds, options.numChannels);
+
+                // Each run appends its own header and blocks to the log
+                std::unique_ptr<TelemetryLogger> logger;
+                if (options.telemetry) {
+                    logger = std::make_unique<TelemetryLogger>(processor->getTelemetry(), options.telemetryFile);
+                }
+
+                const auto result = run(*processor, audio, options, sampleRate, blockSize);
+                logger.reset();
+
+                if (options.csv) {
+                    std::cout << sampleRate << "," << blockSize << "," << (1 << quality) << "," << result.nsPerSample
+                              << "," << result.realtimeFactor << "," << result.p50Micros << "," << result.p99Micros
+                              << "," << result.maxMicros << "," << result.deadlineMicros << "\n";
+                } else {
+                    std::cout << juce::String::formatted("%6.0f Hz  %5d smp  %2dx  %8.2f ns/smp  %8.1fx rt  "
+                                                         "p50 %8.2f us  p99 %8.2f us  max %8.2f us  (deadline %.0f us)",
+                                                         sampleRate,
+                                                         blockSize,
+                                                         1 << quality,
+                                                         result.nsPerSample,
+                                                         result.realtimeFactor,
+                                                         result.p50Micros,
+                                                         result.p99Micros,
+                                                         result.maxMicros,
+                                                         result.deadlineMicros)
+                              << "\n";
+                }
+
+                if (options.maxNsPerSample > 0.0 && result.nsPerSample > options.maxNsPerSample) {
+                    std::cout << "  slower than the " << options.maxNsPerSample << " ns/sample limit\n";
+                    passed = false;
+                }
+
+                // The multiband budget is per band and channel, so it holds for any layout
+                if (options.numBands > 1) {
+                    const auto nsPerBand = result.nsPerSample / (options.numBands * options.numChannels);
+                    const auto budget    = MultibandSaturatorBase::kBudgetNsPerBandSample;
+                    if (!options.csv) {
+                        std::cout << juce::String::formatted("  %.2f ns per band and channel (budget %.0f)\n",
+                                                             nsPerBand,
+                                                             budget);
+                    }
+                    if (nsPerBand > budget) passed = false;
+                }
+            }
+
+            // Golden renders use one fixed block size so they don't depend on the sweep
+            if (options.goldenDirectory != juce::File()) {
+                constexpr int goldenBlockSize = 512;
+                auto processor                = createProcessor(options, sampleRate, goldenBlockSize, quality);
+                auto audio                    = makeInput(sampleRate, options.seconds, options.numChannels);
+                run(*processor, audio, options, sampleRate, goldenBlockSize);
+                passed = checkGolden(options, audio, sampleRate, quality) && passed;
+            }
+        }
+    }
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,378 @@
+// Offline batch renderer: runs audio files through Greg's DSP without a host.
+//
+// Each file is streamed block by block, with reads running ahead on a background thread through a fixed size ring,
+// so memory stays flat whatever the file length. Independent files are spread across a thread pool. Run with --help
+// for the options.
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+#include <cstring>
+#include <iostream>
+
+#include "GregEngine.hpp"
+#include "PresetBank.hpp"
+#include "StateCodec.hpp"
+
+namespace {
+    constexpr int kBlockSize           = 1024;
+    constexpr int kReadAheadSamples    = 64 * kBlockSize;  // Size of the read-ahead ring, per file
+    constexpr juce::uint32 kStateMagic = 0x21324356;        // Header juce::AudioProcessor::copyXmlToBinary writes
+
+    struct Options {
+        GregEngineBase::Parameters parameters;
+        bool isNonRealtime = true;  // Renders get the exact shaper and steep filters unless --realtime is given
+        juce::File outputDirectory;
+        juce::String suffix {"_greg"};
+        int numThreads = juce::SystemStats::getNumCpus();
+        juce::Array<juce::File> inputs;
+    };
+
+    void printUsage() {
+        std::cout << "Usage: GregRender [options] input files...\n"
+                     "  --state=FILE          Start from a saved plugin state (getStateInformation blob or XML)\n"
+                     "  --preset=NAME         Start from a factory or user preset, applied after --state\n"
+                     "  --drive=DB            0 to 30\n"
+                     "  --tone=PERCENT        0 to 100\n"
+                     "  --mix=PERCENT         0 to 100\n"
+                     "  --output=DB           -30 to 30\n"
+                     "  --pre | --post        Tone filter in front of or after the shaper\n"
+                     "  --oversampling=N      1, 2, 4, 8 or 16\n"
+                     "  --min-phase | --linear-phase\n"
+                     "  --adaa=N              Antiderivative anti-aliasing: 0 off, 1 or 2 for first or second order\n"
+                     "  --stereo=MODE         stereo, midside or linked, for the full band path\n"
+                     "  --side-drive=DB       -12 to 12, added to drive for the side signal in midside mode\n"
+                     "  --bands=N             Multiband saturation with 3 or 4 bands, 1 for the full band path\n"
+                     "  --crossovers=HZ,...   Band edges, ascending (default: 120,800,5000)\n"
+                     "  --realtime            Use the realtime processing path instead of the offline one\n"
+                     "  --output-dir=DIR      Where to write the results (default: next to each input)\n"
+                     "  --suffix=TEXT         Appended to the output file names (default: _greg),\n"
+                     "                        may only be empty with --output-dir\n"
+                     "  --jobs=N              Files rendered in parallel (default: number of CPUs)\n"
+                     "Output files keep the input's format (WAV, FLAC or AIFF), channel count and bit depth.\n";
+    }
+
+    // Reads a saved plugin state as an APVTS tree: the binary format, XML wrapped by copyXmlToBinary or plain XML
+    std::unique_ptr<juce::XmlElement> loadState(const juce::File& file) {
+        juce::MemoryBlock data;
+        if (!file.loadFileAsData(data)) return nullptr;
+
+        StateCodec::State state;
+        if (StateCodec::read(data.getData(), data.getSize(), state)) {
+            auto xml = std::make_unique<juce::XmlElement>("Parameters");
+            for (const auto& [id, value] : state.parameters) {
+                auto* param = xml->createNewChildElement("PARAM");
+                param->setAttribute("id", id);
+                param->setAttribute("value", value);
+            }
+            return xml;
+        }
+
+        if (data.getSize() > 8 && juce::ByteOrder::littleEndianInt(data.getData()) == kStateMagic) {
+            const auto* text   = static_cast<const char*>(data.getData()) + 8;
+            const auto maxSize = data.getSize() - 8;
+            return juce::parseXML(juce::String::fromUTF8(text, static_cast<int>(strnlen(text, maxSize))));
+        }
+
+        return juce::parseXML(data.toString());
+    }
+
+    // Per band parameters are numbered from 1 after their prefix, e.g. crossover2 or band3Drive
+    template<size_t size>
+    void setBandValue(std::array<float, size>& values, const juce::String& id, const char* prefix, float value) {
+        const auto index = id.substring(juce::String(prefix).length()).getIntValue() - 1;
+        if (juce::isPositiveAndBelow(index, static_cast<int>(size))) values[static_cast<size_t>(index)] = value;
+    }
+
+    void applyState(const juce::XmlElement& state, GregEngineBase::Parameters& parameters) {
+        for (const auto* param : state.getChildWithTagNameIterator("PARAM")) {
+            const auto id    = param->getStringAttribute("id");
+            const auto value = static_cast<float>(param->getDoubleAttribute("value"));
+
+            if (id == "drive") parameters.drive = value;
+            else if (id == "tone") parameters.tone = value;
+            else if (id == "mix") parameters.mix = value;
+            else if (id == "output") parameters.output = value;
+            else if (id == "pre") parameters.isFilterPre = value > 0.5f;
+            else if (id == "quality") parameters.oversamplingOrder = static_cast<int>(value);
+            else if (id == "renderQuality") parameters.renderOversamplingOrder = static_cast<int>(value);
+            else if (id == "antialiasing") parameters.antialiasingOrder = static_cast<int>(value);
+            else if (id == "stereo") parameters.stereoMode = static_cast<GregEngineBase::StereoMode>(value);
+            else if (id == "sideDrive") parameters.sideDrive = value;
+            else if (id == "bands") parameters.bands.numBands = value < 0.5f ? 1 : static_cast<int>(value) + 2;
+            else if (id.startsWith("crossover")) setBandValue(parameters.bands.crossovers, id, "crossover", value);
+            else if (id.endsWith("Drive")) setBandValue(parameters.bands.driveOffsets, id, "band", value);
+            else if (id.endsWith("Mix")) setBandValue(parameters.bands.mixes, id, "band", value);
+            else if (id == "filter") {
+                using FilterType      = OversamplerBankBase::FilterType;
+                parameters.filterType = value > 0.5f ? FilterType::linearPhase : FilterType::minimumPhase;
+            }
+        }
+    }
+
+    bool parseOptions(const juce::ArgumentList& args, Options& options) {
+        auto& parameters = options.parameters;
+
+        if (args.containsOption("--state")) {
+            const auto path  = args.getValueForOption("--state");
+            const auto file  = juce::File::getCurrentWorkingDirectory().getChildFile(path);
+            const auto state = loadState(file);
+            if (state == nullptr) {
+                std::cerr << "Can't read a plugin state from " << file.getFullPathName() << "\n";
+                return false;
+            }
+            applyState(*state, parameters);
+        }
+
+        if (args.containsOption("--preset")) {
+            const PresetBank presets;
+            const auto name    = args.getValueForOption("--preset");
+            const auto* preset = presets.getPreset(presets.indexOf(name));
+            if (preset == nullptr) {
+                std::cerr << "No preset called " << name << "\n";
+                return false;
+            }
+            preset->applyTo(parameters);
+        }
+
+        const auto getFloat = [&args](const juce::String& option, float& value) {
+            if (args.containsOption(option)) value = args.getValueForOption(option).getFloatValue();
+        };
+
+        getFloat("--drive", parameters.drive);
+        getFloat("--tone", parameters.tone);
+        getFloat("--mix", parameters.mix);
+        getFloat("--output", parameters.output);
+        getFloat("--side-drive", parameters.sideDrive);
+
+        parameters.drive  = juce::jlimit(0.0f, 30.0f, parameters.drive);
+        parameters.tone   = juce::jlimit(0.0f, 100.0f, parameters.tone);
+        parameters.mix    = juce::jlimit(0.0f, 100.0f, parameters.mix);
+        parameters.output = juce::jlimit(-30.0f, 30.0f, parameters.output);
+
+        parameters.sideDrive = juce::jlimit(-12.0f, 12.0f, parameters.sideDrive);
+
+        if (args.containsOption("--pre")) parameters.isFilterPre = true;
+        if (args.containsOption("--post")) parameters.isFilterPre = false;
+        using FilterType = OversamplerBankBase::FilterType;
+        if (args.containsOption("--min-phase")) parameters.filterType = FilterType::minimumPhase;
+        if (args.containsOption("--linear-phase")) parameters.filterType = FilterType::linearPhase;
+
+        if (args.containsOption("--oversampling")) {
+            const auto factor = args.getValueForOption("--oversampling").getIntValue();
+            if (!juce::isPowerOfTwo(factor) || factor < 1 || factor > (1 << OversamplerBankBase::kMaxOrder)) {
+                std::cerr << "--oversampling must be 1, 2, 4, 8 or 16\n";
+                return false;
+            }
+
+            // An explicit factor applies to both paths, so the render uses exactly what was asked for
+            parameters.oversamplingOrder       = juce::roundToInt(std::log2(factor));
+            parameters.renderOversamplingOrder = parameters.oversamplingOrder;
+        }
+
+        if (args.containsOption("--adaa")) {
+            const auto order = args.getValueForOption("--adaa").getIntValue();
+            if (order < 0 || order > 2) {
+                std::cerr << "--adaa must be 0, 1 or 2\n";
+                return false;
+            }
+
+            parameters.antialiasingOrder = order;
+        }
+
+        if (args.containsOption("--stereo")) {
+            using StereoMode = GregEngineBase::StereoMode;
+            const auto mode  = args.getValueForOption("--stereo");
+            if (mode == "stereo") parameters.stereoMode = StereoMode::dual;
+            else if (mode == "midside") parameters.stereoMode = StereoMode::midSide;
+            else if (mode == "linked") parameters.stereoMode = StereoMode::linked;
+            else {
+                std::cerr << "--stereo must be stereo, midside or linked\n";
+                return false;
+            }
+        }
+
+        if (args.containsOption("--bands")) {
+            const auto numBands = args.getValueForOption("--bands").getIntValue();
+            if (numBands != 1 && numBands != 3 && numBands != 4) {
+                std::cerr << "--bands must be 1, 3 or 4\n";
+                return false;
+            }
+
+            parameters.bands.numBands = numBands;
+        }
+
+        if (args.containsOption("--crossovers")) {
+            const auto tokens = juce::StringArray::fromTokens(args.getValueForOption("--crossovers"), ",", {});
+            for (int i = 0; i < juce::jmin(tokens.size(), MultibandSaturatorBase::kMaxCrossovers); ++i) {
+                parameters.bands.crossovers[static_cast<size_t>(i)] = tokens[i].getFloatValue();
+            }
+        }
+
+        options.isNonRealtime = !args.containsOption("--realtime");
+
+        if (args.containsOption("--output-dir")) {
+            const auto path         = args.getValueForOption("--output-dir");
+            options.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(path);
+        }
+        if (args.containsOption("--suffix")) options.suffix = args.getValueForOption("--suffix");
+        if (options.suffix.isEmpty() && options.outputDirectory == juce::File()) {
+            std::cerr << "An empty --suffix needs --output-dir, the results would replace their inputs\n";
+            return false;
+        }
+        if (args.containsOption("--jobs")) {
+            options.numThreads = juce::jmax(1, args.getValueForOption("--jobs").getIntValue());
+        }
+
+        for (const auto& argument : args.arguments) {
+            if (!argument.isOption()) options.inputs.add(argument.resolveAsFile());
+        }
+
+        return true;
+    }
+
+    juce::File getOutputFile(const Options& options, const juce::File& input) {
+        const auto directory = options.outputDirectory == juce::File() ? input.getParentDirectory()
+                                                                       : options.outputDirectory;
+        return directory.getChildFile(input.getFileNameWithoutExtension() + options.suffix + input.getFileExtension());
+    }
+
+    /** Renders one file. Owns its own engine, so any number of these can run side by side. */
+    class RenderJob : public juce::ThreadPoolJob {
+    public:
+        RenderJob(const Options& options, const juce::File& input, juce::AudioFormatManager& formatManager)
+            : juce::ThreadPoolJob(input.getFileName()), mOptions(options), mInput(input),
+              mFormatManager(formatManager) {}
+
+        JobStatus runJob() override {
+            mError = render();
+            return jobHasFinished;
+        }
+
+        const juce::File& getInput() const {
+            return mInput;
+        }
+
+        /** Empty once the file rendered successfully. */
+        const juce::String& getError() const {
+            return mError;
+        }
+
+    private:
+        juce::String render() {
+            // Checked before anything is opened, e.g. --output-dir pointing back at the inputs' own folder
+            const auto outputFile = getOutputFile(mOptions, mInput);
+            if (outputFile == mInput) return "the output would replace the input";
+
+            std::unique_ptr<juce::AudioFormatReader> fileReader(mFormatManager.createReaderFor(mInput));
+            if (fileReader == nullptr) return "unsupported or unreadable file";
+
+            const auto numChannels = static_cast<int>(fileReader->numChannels);
+            const auto sampleRate  = fileReader->sampleRate;
+            const auto length      = fileReader->lengthInSamples;
+            const auto bitDepth    = static_cast<int>(fileReader->bitsPerSample);
+            auto* format           = mFormatManager.findFormatForFileExtension(mInput.getFileExtension());
+            if (format == nullptr) return "unknown output format";
+
+            // Decoding runs ahead on this job's own I/O thread, so it scales with the pool. The buffering reader
+            // keeps a fixed ring of blocks and read() waits until the one it needs is there.
+            juce::TimeSliceThread ioThread("Greg render I/O");
+            ioThread.startThread();
+
+            juce::BufferingAudioReader reader(fileReader.release(), ioThread, kReadAheadSamples);
+            reader.setReadTimeout(-1);
+
+            // Written next to the target and only moved over it once the render succeeded, so a failed or
+            // cancelled job never leaves a truncated file or destroys an existing one
+            outputFile.getParentDirectory().createDirectory();
+            juce::TemporaryFile temporaryFile(outputFile);
+
+            auto stream = temporaryFile.getFile().createOutputStream();
+            if (stream == nullptr) return "can't write " + temporaryFile.getFile().getFullPathName();
+
+            const auto writerChannels = static_cast<unsigned int>(numChannels);
+            std::unique_ptr<juce::AudioFormatWriter> writer(
+              format->createWriterFor(stream.get(), sampleRate, writerChannels, bitDepth, {}, 0));
+            if (writer == nullptr) return "can't create a " + format->getFormatName() + " writer";
+            stream.release();  // Owned by the writer now
+
+            GregEngine<float> engine;
+            engine.prepare(sampleRate, numChannels, kBlockSize, mOptions.parameters, mOptions.isNonRealtime);
+
+            // Drop the first latency samples of output and run that much silence through at the end, so the result
+            // lines up with the input and keeps its length
+            const auto latency = static_cast<juce::int64>(engine.getLatencyInSamples());
+            juce::AudioBuffer<float> block(numChannels, kBlockSize);
+
+            for (juce::int64 position = 0; position < length + latency; position += kBlockSize) {
+                if (shouldExit()) return "cancelled";
+
+                const auto remaining  = length + latency - position;
+                const auto numSamples = static_cast<int>(juce::jmin<juce::int64>(kBlockSize, remaining));
+                block.setSize(numChannels, numSamples, false, false, true);
+
+                // Past the end of the file the reader fills with silence
+                reader.read(&block, 0, numSamples, position, true, true);
+                engine.process(block, mOptions.parameters, mOptions.isNonRealtime);
+
+                const auto skip = static_cast<int>(juce::jlimit<juce::int64>(0, numSamples, latency - position));
+                if (skip < numSamples && !writer->writeFromAudioSampleBuffer(block, skip, numSamples - skip)) {
+                    return "write failed";
+                }
+            }
+
+            writer.reset();  // Flushes and closes the temporary file
+            if (!temporaryFile.overwriteTargetFileWithTemporary()) {
+                return "can't replace " + outputFile.getFullPathName();
+            }
+
+            return {};
+        }
+
+        const Options& mOptions;
+        juce::File mInput;
+        juce::AudioFormatManager& mFormatManager;
+        juce::String mError {"not rendered"};
+    };
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    juce::ArgumentList args(argc, argv);
+
+    Options options;
+    if (args.containsOption("--help|-h") || !parseOptions(args, options) || options.inputs.isEmpty()) {
+        printUsage();
+        return args.containsOption("--help|-h") ? 0 : 1;
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    // Shared by every job, built once up front
+    if (options.parameters.antialiasingOrder > 0) AntiderivativeShaper::buildTable();
+
+    juce::OwnedArray<RenderJob> jobs;
+    {
+        juce::ThreadPool pool(juce::jmin(options.numThreads, options.inputs.size()));
+
+        for (const auto& input : options.inputs) {
+            auto* job = jobs.add(new RenderJob(options, input, formatManager));
+            pool.addJob(job, false);
+        }
+
+        for (auto* job : jobs) {
+            pool.waitForJobToFinish(job, -1);
+        }
+    }
+
+    int numFailed = 0;
+    for (const auto* job : jobs) {
+        if (job->getError().isEmpty()) {
+            std::cout << "ok      " << getOutputFile(options, job->getInput()).getFullPathName() << "\n";
+        } else {
+            std::cout << "FAILED  " << job->getInput().getFullPathName() << ": " << job->getError() << "\n";
+            ++numFailed;
+        }
+    }
+
+    return numFailed == 0 ? 0 : 1;
+}